@@ -0,0 +1,260 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Verifies the dsdelay plugin end to end: pushes a known pattern through a dsdelay
+ * stage into a raw file (behind a null sink) and checks the file holds the same
+ * pattern shifted by the configured delay. Needs a card for the ctl elements; on a
+ * plain Linux box use snd-dummy:
+ *
+ *   modprobe snd-dummy
+ *   ./dsdelay-check -c Dummy -d 20
+ *
+ * The check stands in for the HAL and creates the delay elements on that card. Point
+ * ALSA_PLUGIN_DIR at the build directory to test an uninstalled plugin.
+ */
+
+#define _GNU_SOURCE // For getopt()
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <alsa/asoundlib.h>
+#include "dsAudioDelayCtl.h"
+
+#define CHECK_RATE 48000
+#define CHECK_CHANNELS 2
+#define CHECK_FRAMES (CHECK_RATE / 2)
+#define CHECK_CHUNK_FRAMES 1024
+
+/* Distinct, non-zero sample for every frame and channel of the pattern. */
+static int16_t checkSample(size_t frame, unsigned int channel)
+{
+    int16_t value = (int16_t)(frame % 32749 + 1);
+    return (channel == 0) ? value : (int16_t)-value;
+}
+
+static int checkSetCtl(snd_ctl_t *ctl, const char *name, long ms)
+{
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_value_t *value;
+    int ret;
+
+    snd_ctl_elem_id_alloca(&id);
+    snd_ctl_elem_value_alloca(&value);
+    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_MIXER);
+    snd_ctl_elem_id_set_name(id, name);
+    snd_ctl_elem_value_set_id(value, id);
+    ret = snd_ctl_elem_read(ctl, value);
+    if (ret == -ENOENT) {
+        ret = snd_ctl_elem_add_integer(ctl, id, 1, 0, DSAUDIO_DELAY_MAX_MS, 1);
+        if (ret == -EBUSY || ret == -EEXIST) {
+            ret = 0;
+        }
+    }
+    if (ret < 0) {
+        fprintf(stderr, "Cannot create ctl element %s: %s\n", name, snd_strerror(ret));
+        return ret;
+    }
+    snd_ctl_elem_value_set_integer(value, 0, ms);
+    ret = snd_ctl_elem_write(ctl, value);
+    if (ret < 0) {
+        fprintf(stderr, "Cannot write ctl element %s: %s\n", name, snd_strerror(ret));
+        return ret;
+    }
+    return 0;
+}
+
+static int checkSetDelay(const char *card, long ms)
+{
+    char ctlName[64];
+    snd_ctl_t *ctl = NULL;
+    int ret;
+
+    snprintf(ctlName, sizeof(ctlName), "hw:%s", card);
+    ret = snd_ctl_open(&ctl, ctlName, 0);
+    if (ret < 0) {
+        fprintf(stderr, "Cannot open ctl %s: %s\n", ctlName, snd_strerror(ret));
+        return ret;
+    }
+    ret = checkSetCtl(ctl, DSAUDIO_DELAY_CTL_NAME, ms);
+    if (ret == 0) {
+        ret = checkSetCtl(ctl, DSAUDIO_DELAY_OFFSET_CTL_NAME, 0);
+    }
+    snd_ctl_close(ctl);
+    return ret;
+}
+
+/* dsdelay -> file -> null, defined in a local config so no installed asound.conf is needed. */
+static int checkOpenPcm(snd_pcm_t **pcm, const char *card, const char *path)
+{
+    char text[512];
+    snd_config_t *conf = NULL;
+    snd_input_t *in = NULL;
+    int ret;
+
+    snprintf(text, sizeof(text),
+            "pcm.dsdelay_check {\n"
+            "    type dsdelay\n"
+            "    card \"%s\"\n"
+            "    slave.pcm {\n"
+            "        type file\n"
+            "        slave.pcm { type null }\n"
+            "        file \"%s\"\n"
+            "        format raw\n"
+            "    }\n"
+            "}\n", card, path);
+    ret = snd_config_top(&conf);
+    if (ret == 0) {
+        ret = snd_input_buffer_open(&in, text, strlen(text));
+    }
+    if (ret == 0) {
+        ret = snd_config_load(conf, in);
+        snd_input_close(in);
+    }
+    if (ret == 0) {
+        ret = snd_pcm_open_lconf(pcm, "dsdelay_check", SND_PCM_STREAM_PLAYBACK, 0, conf);
+    }
+    if (conf != NULL) {
+        snd_config_delete(conf);
+    }
+    if (ret == 0) {
+        ret = snd_pcm_set_params(*pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                CHECK_CHANNELS, CHECK_RATE, 0, 100000);
+        if (ret < 0) {
+            snd_pcm_close(*pcm);
+        }
+    }
+    if (ret < 0) {
+        fprintf(stderr, "Cannot open the dsdelay check PCM: %s\n", snd_strerror(ret));
+    }
+    return ret;
+}
+
+static int checkPlay(snd_pcm_t *pcm)
+{
+    int16_t chunk[CHECK_CHUNK_FRAMES * CHECK_CHANNELS];
+    size_t frame = 0;
+
+    while (frame < CHECK_FRAMES) {
+        size_t count = CHECK_FRAMES - frame;
+        if (count > CHECK_CHUNK_FRAMES) {
+            count = CHECK_CHUNK_FRAMES;
+        }
+        for (size_t i = 0; i < count; i++) {
+            for (unsigned int c = 0; c < CHECK_CHANNELS; c++) {
+                chunk[i * CHECK_CHANNELS + c] = checkSample(frame + i, c);
+            }
+        }
+        snd_pcm_sframes_t written = snd_pcm_writei(pcm, chunk, count);
+        if (written < 0) {
+            written = snd_pcm_recover(pcm, (int)written, 0);
+        }
+        if (written < 0) {
+            fprintf(stderr, "snd_pcm_writei failed: %s\n", snd_strerror((int)written));
+            return (int)written;
+        }
+        frame += (size_t)written;
+    }
+    return snd_pcm_drain(pcm);
+}
+
+/*
+ * Output frame i must be input frame i - delay, silence before that. The plugin
+ * cannot flush its ring on drain, so the output holds exactly CHECK_FRAMES frames.
+ */
+static bool checkVerify(const char *path, size_t delayFrames)
+{
+    int16_t frameData[CHECK_CHANNELS];
+    FILE *f = fopen(path, "rb");
+    size_t frame = 0;
+    bool ok = true;
+
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+    while (ok && fread(frameData, sizeof(frameData), 1, f) == 1) {
+        for (unsigned int c = 0; c < CHECK_CHANNELS; c++) {
+            int16_t expected = (frame < delayFrames) ? 0 : checkSample(frame - delayFrames, c);
+            if (frameData[c] != expected) {
+                fprintf(stderr, "Frame %zu channel %u: got %d, expected %d\n",
+                        frame, c, frameData[c], expected);
+                ok = false;
+            }
+        }
+        frame++;
+    }
+    fclose(f);
+    if (ok && frame != CHECK_FRAMES) {
+        fprintf(stderr, "Got %zu frames, expected %d\n", frame, CHECK_FRAMES);
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const char *card = "Dummy";
+    const char *path = "/tmp/dsdelay-check.raw";
+    long delayMs = 20;
+    snd_pcm_t *pcm = NULL;
+    bool ok;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:d:f:h")) != -1) {
+        switch (opt) {
+        case 'c':
+            card = optarg;
+            break;
+        case 'd':
+            delayMs = strtol(optarg, NULL, 10);
+            break;
+        case 'f':
+            path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-c card] [-d delay ms, 0-%d] [-f output file]\n",
+                    argv[0], DSAUDIO_DELAY_MAX_MS);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (delayMs < 0 || delayMs > DSAUDIO_DELAY_MAX_MS) {
+        fprintf(stderr, "Delay must be 0-%d ms\n", DSAUDIO_DELAY_MAX_MS);
+        return 1;
+    }
+
+    if (checkSetDelay(card, delayMs) < 0 || checkOpenPcm(&pcm, card, path) < 0) {
+        return 1;
+    }
+    int ret = checkPlay(pcm);
+    snd_pcm_close(pcm);
+    if (ret < 0) {
+        fprintf(stderr, "Playback failed: %s\n", snd_strerror(ret));
+        return 1;
+    }
+
+    ok = checkVerify(path, (size_t)(delayMs * CHECK_RATE / 1000));
+    printf("dsdelay %ld ms over %d frames: %s\n", delayMs, CHECK_FRAMES, ok ? "PASS" : "FAIL");
+    checkSetDelay(card, 0);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ALSA "dsdelay" PCM filter plugin.
+ *
+ * Delays the stream by a whole number of frames using a ring buffer. The delay is
+ * the sum of two integer ctl elements in milliseconds, created and written by the DS
+ * HAL (dsSetAudioDelay / dsSetAudioDelayOffset) and converted to frames at the stream
+ * rate. Until the HAL has created them the stream plays undelayed.
+ *
+ * The extplug API has no drain hook, so the last delay's worth of audio is still in
+ * the ring when the stream drains and never reaches the slave. Clients that need the
+ * tail should end the stream with that much silence.
+ *
+ * pcm.name {
+ *     type dsdelay
+ *     slave.pcm "..."
+ *     card vc4hdmi0                          # card holding the ctl elements
+ *     delay_control "DS Audio Delay"         # optional
+ *     offset_control "DS Audio Delay Offset" # optional
+ * }
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <alsa/asoundlib.h>
+#include <alsa/pcm_external.h>
+#include "dsAudioDelayCtl.h"
+
+/* Re-read the ctl elements roughly every 100 ms of audio. */
+#define DSDELAY_CHECK_DIVISOR 10
+
+typedef struct {
+    snd_pcm_extplug_t ext;
+    snd_ctl_t *ctl;
+    snd_ctl_elem_value_t *delayValue;
+    snd_ctl_elem_value_t *offsetValue;
+    int16_t *ring;                  /* ringFrames * channels interleaved samples */
+    snd_pcm_uframes_t ringFrames;
+    snd_pcm_uframes_t writePos;
+    snd_pcm_uframes_t delayFrames;
+    snd_pcm_uframes_t sinceCheck;
+} dsdelay_t;
+
+static long dsdelay_read_ms(dsdelay_t *dd, snd_ctl_elem_value_t *value)
+{
+    long ms;
+
+    if (value == NULL || snd_ctl_elem_read(dd->ctl, value) < 0) {
+        return 0;
+    }
+    ms = snd_ctl_elem_value_get_integer(value, 0);
+    return (ms < 0) ? 0 : (ms > DSAUDIO_DELAY_MAX_MS) ? DSAUDIO_DELAY_MAX_MS : ms;
+}
+
+static void dsdelay_refresh(dsdelay_t *dd)
+{
+    snd_pcm_uframes_t frames;
+
+    dd->sinceCheck = 0;
+    if (dd->ctl == NULL || dd->ring == NULL) {
+        return;
+    }
+    frames = (snd_pcm_uframes_t)(dsdelay_read_ms(dd, dd->delayValue) + dsdelay_read_ms(dd, dd->offsetValue))
+            * dd->ext.rate / 1000;
+    if (frames >= dd->ringFrames) {
+        frames = dd->ringFrames - 1;
+    }
+    dd->delayFrames = frames;
+}
+
+static inline int16_t *dsdelay_area_addr(const snd_pcm_channel_area_t *area, snd_pcm_uframes_t offset)
+{
+    return (int16_t *)((char *)area->addr + ((area->first + area->step * offset) >> 3));
+}
+
+static snd_pcm_sframes_t dsdelay_transfer(snd_pcm_extplug_t *ext,
+        const snd_pcm_channel_area_t *dst_areas, snd_pcm_uframes_t dst_offset,
+        const snd_pcm_channel_area_t *src_areas, snd_pcm_uframes_t src_offset,
+        snd_pcm_uframes_t size)
+{
+    dsdelay_t *dd = ext->private_data;
+    unsigned int channels = ext->channels;
+
+    if (dd->sinceCheck >= ext->rate / DSDELAY_CHECK_DIVISOR) {
+        dsdelay_refresh(dd);
+    }
+    dd->sinceCheck += size;
+
+    if (dd->ring == NULL) {
+        snd_pcm_areas_copy(dst_areas, dst_offset, src_areas, src_offset, channels, size, SND_PCM_FORMAT_S16);
+        return size;
+    }
+
+    for (snd_pcm_uframes_t i = 0; i < size; i++) {
+        snd_pcm_uframes_t readPos = (dd->writePos + dd->ringFrames - dd->delayFrames) % dd->ringFrames;
+        int16_t *slot = dd->ring + dd->writePos * channels;
+        const int16_t *delayed = dd->ring + readPos * channels;
+
+        for (unsigned int c = 0; c < channels; c++) {
+            slot[c] = *dsdelay_area_addr(&src_areas[c], src_offset + i);
+        }
+        for (unsigned int c = 0; c < channels; c++) {
+            *dsdelay_area_addr(&dst_areas[c], dst_offset + i) = delayed[c];
+        }
+        dd->writePos = (dd->writePos + 1) % dd->ringFrames;
+    }
+    return size;
+}
+
+static int dsdelay_init(snd_pcm_extplug_t *ext)
+{
+    dsdelay_t *dd = ext->private_data;
+    /* Two elements of up to DSAUDIO_DELAY_MAX_MS each, plus the current frame. */
+    snd_pcm_uframes_t frames = (snd_pcm_uframes_t)ext->rate * (2 * DSAUDIO_DELAY_MAX_MS) / 1000 + 1;
+
+    free(dd->ring);
+    dd->ring = calloc(frames * ext->channels, sizeof(int16_t));
+    if (dd->ring == NULL) {
+        dd->ringFrames = 0;
+        return -ENOMEM;
+    }
+    dd->ringFrames = frames;
+    dd->writePos = 0;
+    dsdelay_refresh(dd);
+    return 0;
+}
+
+static int dsdelay_close(snd_pcm_extplug_t *ext)
+{
+    dsdelay_t *dd = ext->private_data;
+
+    if (dd->delayValue != NULL) {
+        snd_ctl_elem_value_free(dd->delayValue);
+    }
+    if (dd->offsetValue != NULL) {
+        snd_ctl_elem_value_free(dd->offsetValue);
+    }
+    if (dd->ctl != NULL) {
+        snd_ctl_close(dd->ctl);
+    }
+    free(dd->ring);
+    free(dd);
+    return 0;
+}
+
+static const snd_pcm_extplug_callback_t dsdelay_callback = {
+    .transfer = dsdelay_transfer,
+    .init = dsdelay_init,
+    .close = dsdelay_close,
+};
+
+/*
+ * Binds an integer ms element by name. The HAL owns the element; if it does not exist
+ * yet, reads fail (delay 0) until the HAL creates it and the next refresh finds it.
+ */
+static snd_ctl_elem_value_t *dsdelay_bind_ctl(const char *name)
+{
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_value_t *value = NULL;
+
+    snd_ctl_elem_id_alloca(&id);
+    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_MIXER);
+    snd_ctl_elem_id_set_name(id, name);
+    if (snd_ctl_elem_value_malloc(&value) < 0) {
+        return NULL;
+    }
+    snd_ctl_elem_value_set_id(value, id);
+    return value;
+}
+
+SND_PCM_PLUGIN_DEFINE_FUNC(dsdelay)
+{
+    snd_config_iterator_t i, next;
+    snd_config_t *slave = NULL;
+    const char *card = NULL;
+    const char *delayName = DSAUDIO_DELAY_CTL_NAME;
+    const char *offsetName = DSAUDIO_DELAY_OFFSET_CTL_NAME;
+    dsdelay_t *dd;
+    int err;
+
+    snd_config_for_each(i, next, conf) {
+        snd_config_t *n = snd_config_iterator_entry(i);
+        const char *id;
+        if (snd_config_get_id(n, &id) < 0) {
+            continue;
+        }
+        if (strcmp(id, "comment") == 0 || strcmp(id, "type") == 0 || strcmp(id, "hint") == 0) {
+            continue;
+        }
+        if (strcmp(id, "slave") == 0) {
+            slave = n;
+            continue;
+        }
+        if (strcmp(id, "card") == 0) {
+            snd_config_get_string(n, &card);
+            continue;
+        }
+        if (strcmp(id, "delay_control") == 0) {
+            snd_config_get_string(n, &delayName);
+            continue;
+        }
+        if (strcmp(id, "offset_control") == 0) {
+            snd_config_get_string(n, &offsetName);
+            continue;
+        }
+        SNDERR("Unknown field %s", id);
+        return -EINVAL;
+    }
+    if (slave == NULL) {
+        SNDERR("No slave defined for dsdelay");
+        return -EINVAL;
+    }
+
+    dd = calloc(1, sizeof(*dd));
+    if (dd == NULL) {
+        return -ENOMEM;
+    }
+    dd->ext.version = SND_PCM_EXTPLUG_VERSION;
+    dd->ext.name = "DS HAL audio delay plugin";
+    dd->ext.callback = &dsdelay_callback;
+    dd->ext.private_data = dd;
+
+    /* Without the ctl the stream still plays, just undelayed (e.g. against a null slave). */
+    if (card != NULL) {
+        char ctlName[64];
+        snprintf(ctlName, sizeof(ctlName), "hw:%s", card);
+        if (snd_ctl_open(&dd->ctl, ctlName, 0) == 0) {
+            dd->delayValue = dsdelay_bind_ctl(delayName);
+            dd->offsetValue = dsdelay_bind_ctl(offsetName);
+        } else {
+            SNDERR("dsdelay: cannot open ctl %s; delay disabled", ctlName);
+            dd->ctl = NULL;
+        }
+    }
+
+    err = snd_pcm_extplug_create(&dd->ext, name, root, slave, stream, mode);
+    if (err < 0) {
+        dsdelay_close(&dd->ext);
+        return err;
+    }
+
+    snd_pcm_extplug_set_param(&dd->ext, SND_PCM_EXTPLUG_HW_FORMAT, SND_PCM_FORMAT_S16);
+    snd_pcm_extplug_set_slave_param(&dd->ext, SND_PCM_EXTPLUG_HW_FORMAT, SND_PCM_FORMAT_S16);
+
+    *pcmp = dd->ext.pcm;
+    return 0;
+}
+
+SND_PCM_PLUGIN_SYMBOL(dsdelay);
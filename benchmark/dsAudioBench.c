@@ -0,0 +1,334 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Latency benchmark for the audio HAL APIs.
+ *
+ * Runs each API N times against libdshal.so and reports p50/p99/max latency and
+ * heap allocations per call on the calling thread. On a plain Linux box, use the
+ * snd-dummy card and the bundled ALSA config as the HDMI stand-in:
+ *
+ *   modprobe snd-dummy
+ *   ALSA_CONFIG_PATH=/usr/share/alsa/alsa.conf:benchmark/asound-bench.conf \
+ *   DSHAL_ALSA_CARD=hw:Dummy ./dshal-audio-bench -n 5000
+ */
+
+#define _GNU_SOURCE // For RTLD_NEXT
+#include <dlfcn.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <alsa/asoundlib.h>
+#include "dsAudio.h"
+#include "dsError.h"
+
+#define BENCH_DEFAULT_ITERATIONS 5000
+#define BENCH_WARMUP_ITERATIONS 50
+
+/* Heap allocation counter for the calling thread; the HAL's own threads are not counted. */
+static __thread unsigned long tAllocCount = 0;
+
+/*
+ * The wrappers below interpose on the allocator and forward to the next definition,
+ * resolved with dlsym(RTLD_NEXT). dlsym() may itself allocate while resolving, so those
+ * requests are served from a small static buffer that free() never releases.
+ */
+static void *(*realMalloc)(size_t size) = NULL;
+static void *(*realCalloc)(size_t nmemb, size_t size) = NULL;
+static void *(*realRealloc)(void *ptr, size_t size) = NULL;
+static void (*realFree)(void *ptr) = NULL;
+
+static _Alignas(max_align_t) unsigned char gBootstrapHeap[4096];
+static size_t gBootstrapUsed = 0;
+static bool gResolving = false;
+
+static void *benchBootstrapAlloc(size_t size)
+{
+    size_t aligned = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+    if (aligned < size || aligned > sizeof(gBootstrapHeap) - gBootstrapUsed) {
+        return NULL;
+    }
+    void *ptr = &gBootstrapHeap[gBootstrapUsed];
+    gBootstrapUsed += aligned;
+    return ptr;
+}
+
+static bool benchIsBootstrapPtr(const void *ptr)
+{
+    return (const unsigned char *)ptr >= gBootstrapHeap &&
+        (const unsigned char *)ptr < gBootstrapHeap + sizeof(gBootstrapHeap);
+}
+
+__attribute__((constructor))
+static void benchResolveAllocator(void)
+{
+    if (realMalloc != NULL || gResolving) {
+        return;
+    }
+    gResolving = true;
+    realCalloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+    realRealloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+    realFree = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+    realMalloc = (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc");
+    gResolving = false;
+    if (realMalloc == NULL || realCalloc == NULL || realRealloc == NULL || realFree == NULL) {
+        fprintf(stderr, "Failed to resolve the allocator: %s\n", dlerror());
+        abort();
+    }
+}
+
+void *malloc(size_t size)
+{
+    tAllocCount++;
+    if (realMalloc == NULL) {
+        if (gResolving) {
+            return benchBootstrapAlloc(size);
+        }
+        benchResolveAllocator();
+    }
+    return realMalloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    tAllocCount++;
+    if (realMalloc == NULL) {
+        if (gResolving) {
+            /* The static buffer is zeroed and never reused. */
+            return (size != 0 && nmemb > SIZE_MAX / size) ? NULL : benchBootstrapAlloc(nmemb * size);
+        }
+        benchResolveAllocator();
+    }
+    return realCalloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    tAllocCount++;
+    if (realMalloc == NULL) {
+        if (gResolving) {
+            return ptr == NULL ? benchBootstrapAlloc(size) : NULL;
+        }
+        benchResolveAllocator();
+    }
+    if (benchIsBootstrapPtr(ptr)) {
+        /* The old size is unknown; copy what fits, never past the end of the buffer. */
+        void *moved = realMalloc(size);
+        if (moved != NULL) {
+            size_t avail = (size_t)(gBootstrapHeap + sizeof(gBootstrapHeap) - (unsigned char *)ptr);
+            memcpy(moved, ptr, size < avail ? size : avail);
+        }
+        return moved;
+    }
+    return realRealloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr == NULL || benchIsBootstrapPtr(ptr)) {
+        return;
+    }
+    if (realFree == NULL) {
+        benchResolveAllocator();
+    }
+    realFree(ptr);
+}
+
+typedef dsError_t (*benchFn_t)(intptr_t handle, unsigned int iteration);
+
+typedef struct {
+    const char *name;
+    benchFn_t fn;
+} benchCase_t;
+
+static dsError_t benchGetAudioGain(intptr_t handle, unsigned int iteration)
+{
+    float gain;
+    (void)iteration;
+    return dsGetAudioGain(handle, &gain);
+}
+
+static dsError_t benchSetAudioGain(intptr_t handle, unsigned int iteration)
+{
+    return dsSetAudioGain(handle, (float)(40 + (iteration % 20)));
+}
+
+static dsError_t benchIsAudioMute(intptr_t handle, unsigned int iteration)
+{
+    bool muted;
+    (void)iteration;
+    return dsIsAudioMute(handle, &muted);
+}
+
+static dsError_t benchSetAudioMute(intptr_t handle, unsigned int iteration)
+{
+    return dsSetAudioMute(handle, (iteration & 1) != 0);
+}
+
+static dsError_t benchGetAudioLevel(intptr_t handle, unsigned int iteration)
+{
+    float level;
+    (void)iteration;
+    return dsGetAudioLevel(handle, &level);
+}
+
+static dsError_t benchGetAudioEncoding(intptr_t handle, unsigned int iteration)
+{
+    dsAudioEncoding_t encoding;
+    (void)iteration;
+    return dsGetAudioEncoding(handle, &encoding);
+}
+
+static const benchCase_t kBenchCases[] = {
+    { "dsGetAudioGain", benchGetAudioGain },
+    { "dsSetAudioGain", benchSetAudioGain },
+    { "dsIsAudioMute", benchIsAudioMute },
+    { "dsSetAudioMute", benchSetAudioMute },
+    { "dsGetAudioLevel", benchGetAudioLevel },
+    { "dsGetAudioEncoding", benchGetAudioEncoding },
+};
+
+static uint64_t benchNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int benchCompareU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Opens and closes a PCM so softvol stages create their controls before the HAL looks for them. */
+static void benchPrimePcm(const char *pcmName)
+{
+    snd_pcm_t *pcm = NULL;
+
+    if (pcmName == NULL) {
+        return;
+    }
+    if (snd_pcm_open(&pcm, pcmName, SND_PCM_STREAM_PLAYBACK, 0) == 0) {
+        snd_pcm_close(pcm);
+    } else {
+        fprintf(stderr, "warning: could not open PCM %s for priming\n", pcmName);
+    }
+}
+
+static void benchRun(const benchCase_t *bench, intptr_t handle, unsigned int iterations, uint64_t *samples)
+{
+    unsigned long allocs = 0;
+    unsigned int failures = 0;
+
+    for (unsigned int i = 0; i < BENCH_WARMUP_ITERATIONS; i++) {
+        (void)bench->fn(handle, i);
+    }
+
+    for (unsigned int i = 0; i < iterations; i++) {
+        unsigned long allocsBefore = tAllocCount;
+        uint64_t start = benchNowNs();
+        dsError_t ret = bench->fn(handle, i);
+        samples[i] = benchNowNs() - start;
+        allocs += tAllocCount - allocsBefore;
+        if (ret != dsERR_NONE) {
+            failures++;
+        }
+    }
+
+    qsort(samples, iterations, sizeof(samples[0]), benchCompareU64);
+    printf("%-20s %10.1f %10.1f %10.1f %12.2f %8u\n", bench->name,
+            samples[iterations / 2] / 1000.0,
+            samples[(size_t)((iterations - 1) * 0.99)] / 1000.0,
+            samples[iterations - 1] / 1000.0,
+            (double)allocs / iterations, failures);
+}
+
+static void benchUsage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n iterations] [-p pcm-to-prime] [-f filter]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int iterations = BENCH_DEFAULT_ITERATIONS;
+    const char *primePcm = "default";
+    const char *filter = NULL;
+    intptr_t handle = 0;
+    uint64_t *samples;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:p:f:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                primePcm = (strcmp(optarg, "none") == 0) ? NULL : optarg;
+                break;
+            case 'f':
+                filter = optarg;
+                break;
+            default:
+                benchUsage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (iterations == 0) {
+        benchUsage(argv[0]);
+        return 1;
+    }
+
+    benchPrimePcm(primePcm);
+
+    if (dsAudioPortInit() != dsERR_NONE) {
+        fprintf(stderr, "dsAudioPortInit failed\n");
+        return 1;
+    }
+    if (dsGetAudioPort(dsAUDIOPORT_TYPE_HDMI, 0, &handle) != dsERR_NONE) {
+        fprintf(stderr, "dsGetAudioPort(HDMI, 0) failed\n");
+        dsAudioPortTerm();
+        return 1;
+    }
+
+    samples = malloc(iterations * sizeof(*samples));
+    if (samples == NULL) {
+        dsAudioPortTerm();
+        return 1;
+    }
+
+    printf("%u iterations per API\n", iterations);
+    printf("%-20s %10s %10s %10s %12s %8s\n", "api", "p50(us)", "p99(us)", "max(us)", "allocs/call", "errors");
+    for (size_t i = 0; i < sizeof(kBenchCases) / sizeof(kBenchCases[0]); i++) {
+        if (filter != NULL && strstr(kBenchCases[i].name, filter) == NULL) {
+            continue;
+        }
+        benchRun(&kBenchCases[i], handle, iterations, samples);
+    }
+
+    free(samples);
+    dsAudioPortTerm();
+    return 0;
+}
@@ -21,13 +21,22 @@
 #include "dsAudio.h"
 #include <stdint.h>
 #include <math.h>
+#include <poll.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <libudev.h>
 #include "dsError.h"
 #include "dsUtl.h"
 #include "dshalUtils.h"
 #include <alsa/asoundlib.h>
 #include "dshalLogger.h"
 #include "dsAudioSettings.h"
+#include "dsAudioTransaction.h"
+#include "dsAudioDelayCtl.h"
 
 #define ALSA_CARD_NAME "hw:vc4hdmi0"
 #define ALSA_CARD_NAME_FALLBACK "hw:vc4hdmi1"
@@ -37,6 +46,9 @@
 /* vc4hdmi0 exposes IEC958 controls; PCM/HDMI simple mixer elements are not present on this card. */
 #define ALSA_ELEMENT_NAME "IEC958"
 #define ALSA_SOFTVOL_ELEMENT_NAME "SoftMaster"
+#define ALSA_DUCK_ELEMENT_NAME "SoftDuck"
+/* Per-input softvol stages from config/asound.conf. */
+#define ALSA_PRIMARY_ELEMENT_NAME "SoftPrimary"
 #define ALSA_IEC958_CTL_NAME "IEC958 Playback Default"
 
 #define MAX_LINEAR_DB_SCALE 24
@@ -56,14 +68,189 @@ static bool _isms11Enabled = false;
 static dsAudioStereoMode_t _stereoModeHDMI = dsAUDIO_STEREO_STEREO;
 static bool _bIsAudioInitialized = false;
 static long _softvolSavedVolume = -1;
+/* Last delay/offset written; reapplied if the ctl elements are missing at init. */
+static uint32_t _audioDelayMs = 0;
+static uint32_t _audioDelayOffsetMs = 0;
+static pthread_mutex_t gAudioDelayMutex = PTHREAD_MUTEX_INITIALIZER;
 
-dsAudioOutPortConnectCB_t _halhdmiaudioCB = NULL;
+static dsAudioOutPortConnectCB_t _halhdmiaudioCB = NULL;
 dsAudioFormatUpdateCB_t _halaudioformatCB = NULL;
-pthread_mutex_t gHdmiAudioCbMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t gHdmiAudioCbMutex = PTHREAD_MUTEX_INITIALIZER;
+/* Display event subscription that drives _halhdmiaudioCB; 0 when not subscribed. */
+static uint32_t _hdmiAudioEventToken = 0;
+
+/* HDMI audio follows the display connector state; EDID re-announcements are not forwarded. */
+static void hdmiAudioDisplayEvent(const dsDisplayEventInfo_t *info, void *userData)
+{
+    dsAudioOutPortConnectCB_t cb;
+
+    (void)userData;
+    if (!info->stateChanged) {
+        return;
+    }
+    pthread_mutex_lock(&gHdmiAudioCbMutex);
+    cb = _halhdmiaudioCB;
+    pthread_mutex_unlock(&gHdmiAudioCbMutex);
+    if (cb != NULL) {
+        cb(dsAUDIOPORT_TYPE_HDMI, 0, info->connected);
+    }
+}
+
+#define DSAUDIO_GAIN_STEPS 101
+
+/*
+ * Gain conversion tables built once per resolved element by dsGetdBRange().
+ * Index is the 0-100 gain/level step; callers interpolate between steps.
+ */
+typedef struct {
+    bool valid;
+    bool hasDbRange;
+    bool logScale;                          /* dB span wider than MAX_LINEAR_DB_SCALE */
+    long volMin;                            /* raw playback volume range */
+    long volMax;
+    long dbMin;                             /* playback dB range in 1/100 dB */
+    long dbMax;
+    long gainToDb[DSAUDIO_GAIN_STEPS];      /* 1/100 dB for each gain step */
+    long gainToRaw[DSAUDIO_GAIN_STEPS];     /* raw volume for each gain step */
+    long levelToRaw[DSAUDIO_GAIN_STEPS];    /* raw volume for each level step (non-softvol halves min) */
+} dsAudioGainTables_t;
+
+/*
+ * Long-lived mixer session shared by all volume/mute APIs. The playback element is
+ * resolved once (SoftMaster or IEC958) and only re-resolved after ALSA reports that
+ * the element was removed, instead of re-probing every candidate card on each call.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    const char *card;
+    snd_mixer_t *mixer;
+    snd_mixer_elem_t *elem;
+    bool usingSoftvol;
+    dsAudioGainTables_t gain;
+    snd_mixer_t *iec958Mixer;
+    snd_mixer_elem_t *iec958Elem;
+    bool iec958Probed;
+    bool stale;
+} dsAudioMixerSession_t;
+
+/* In-memory copy of the mixer and IEC958 state, kept current by the audio monitor thread. */
+typedef struct {
+    bool muteValid;
+    bool muted;
+    bool gainValid;
+    float gain;
+    bool dbValid;
+    float db;
+    bool levelValid;
+    float level;
+    bool iec958Valid;
+    int iec958Enabled;
+} dsAudioStateSnapshot_t;
+
+typedef struct {
+    pthread_mutex_t stateMutex;
+    dsAudioStateSnapshot_t state;
+    bool stateValid;
+    pthread_t thread;
+    bool threadRunning;
+    atomic_bool stopRequested;
+    int wakeFd;
+    struct udev *udev;
+    struct udev_monitor *soundMonitor;
+    int soundFd;
+} dsAudioMonitorContext_t;
+
+static dsAudioMonitorContext_t gAudioMonitorCtx = {
+    .stateMutex = PTHREAD_MUTEX_INITIALIZER,
+    .stateValid = false,
+    .threadRunning = false,
+    .stopRequested = false,
+    .wakeFd = -1,
+    .udev = NULL,
+    .soundMonitor = NULL,
+    .soundFd = -1,
+};
+
+/* Open IEC958 ctl bound to the selected card; elem id is reduced to its numid after snd_ctl_elem_info(). */
+typedef struct {
+    pthread_mutex_t mutex;
+    const char *card;
+    snd_ctl_t *ctl;
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_value_t *value;
+    unsigned int numid;
+} dsIec958CtlContext_t;
+
+static dsIec958CtlContext_t gIec958Ctl = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .card = NULL,
+    .ctl = NULL,
+    .id = NULL,
+    .value = NULL,
+    .numid = 0,
+};
+
+/*
+ * Ducking envelope on the SoftDuck softvol stage, which sits in front of SoftMaster so
+ * the attenuation multiplies with the user gain. Positions are 0-100 on the element range.
+ */
+#define DSAUDIO_DUCK_RAMP_STEPS 20
+#define DSAUDIO_DUCK_STEP_MS 10
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool threadRunning;
+    bool stopRequested;
+    bool active;                    /* between START and STOP */
+    dsAudioDuckingType_t type;
+    unsigned char level;
+    float current;                  /* last position written */
+    float target;
+    float stepSize;                 /* per-step change of the running ramp */
+    int rampSteps;
+    int stepIntervalMs;
+} dsAudioDuckContext_t;
+
+static dsAudioDuckContext_t gAudioDuck = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .threadRunning = false,
+    .stopRequested = false,
+    .active = false,
+    .current = 100.0f,
+    .target = 100.0f,
+    .stepSize = 0.0f,
+    .rampSteps = DSAUDIO_DUCK_RAMP_STEPS,
+    .stepIntervalMs = DSAUDIO_DUCK_STEP_MS,
+};
+
+/* Only used while neither the ctl nor the sound udev watch is open, to retry the ctl. */
+#define DSAUDIO_MONITOR_CTL_RETRY_MS 1000
+#define DSAUDIO_MONITOR_MAX_FDS 8
+
+/* Selected HDMI card; NULL until probed and after the sound udev watcher invalidates it. */
+static _Atomic(const char *) gSelectedAlsaCard = NULL;
+static pthread_mutex_t gAlsaCardProbeMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static dsAudioMixerSession_t gMixerSession = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .card = NULL,
+    .mixer = NULL,
+    .elem = NULL,
+    .usingSoftvol = false,
+    .gain = { .valid = false },
+    .iec958Mixer = NULL,
+    .iec958Elem = NULL,
+    .iec958Probed = false,
+    .stale = false,
+};
 
 static int8_t initAlsa(const char *selemname, const char *s_card, snd_mixer_t **mixer, snd_mixer_elem_t **element);
 static int dsIec958CtlReadSwitch(const char *s_card, int *iec958_enabled);
 static void dsCloseMixerHandle(snd_mixer_t **mixer);
+static void dsAudioMonitorWake(void);
+static void dsAudioStateUpdateLocked(bool markValid);
 
 static int dsInitAudioMixerElem(const char *s_card, snd_mixer_t **mixer, snd_mixer_elem_t **mixer_elem, bool *usingSoftvol)
 {
@@ -145,22 +332,42 @@ static int dsInitAudioMixerElem(const char *s_card, snd_mixer_t **mixer, snd_mix
     return -1;
 }
 
+/*
+ * Returns the selected HDMI card. The probe result is published through an atomic
+ * pointer so readers never lock; the sound udev watcher clears it when cards come
+ * or go and the next caller re-probes.
+ */
 static const char *dsGetPreferredAlsaCard(void)
 {
-    static const char *selected_card = NULL;
     const char *hdmiCardCandidates[] = {
         ALSA_CARD_NAME,
         ALSA_CARD_NAME_FALLBACK,
         ALSA_CARD_INDEX_PRIMARY,
         ALSA_CARD_INDEX_FALLBACK
     };
+    const char *selected_card = atomic_load_explicit(&gSelectedAlsaCard, memory_order_acquire);
     int iec958_enabled = 0;
 
     if (selected_card != NULL) {
         return selected_card;
     }
 
-    for (size_t i = 0; i < (sizeof(hdmiCardCandidates) / sizeof(hdmiCardCandidates[0])); i++) {
+    pthread_mutex_lock(&gAlsaCardProbeMutex);
+    selected_card = atomic_load_explicit(&gSelectedAlsaCard, memory_order_acquire);
+    if (selected_card != NULL) {
+        pthread_mutex_unlock(&gAlsaCardProbeMutex);
+        return selected_card;
+    }
+
+#ifdef DSHAL_ENABLE_BENCHMARK
+    /* Benchmark builds only: explicit override, e.g. hw:Dummy; the string lives for the process. */
+    selected_card = getenv("DSHAL_ALSA_CARD");
+    if (selected_card != NULL && *selected_card == '\0') {
+        selected_card = NULL;
+    }
+#endif /* DSHAL_ENABLE_BENCHMARK */
+
+    for (size_t i = 0; (selected_card == NULL) && (i < (sizeof(hdmiCardCandidates) / sizeof(hdmiCardCandidates[0]))); i++) {
         if (dsIec958CtlReadSwitch(hdmiCardCandidates[i], &iec958_enabled) == 0) {
             selected_card = hdmiCardCandidates[i];
             break;
@@ -172,6 +379,9 @@ static const char *dsGetPreferredAlsaCard(void)
         selected_card = ALSA_CARD_NAME;
     }
 
+    atomic_store_explicit(&gSelectedAlsaCard, selected_card, memory_order_release);
+    pthread_mutex_unlock(&gAlsaCardProbeMutex);
+
     hal_info("Selected ALSA HDMI card: %s\n", selected_card);
     return selected_card;
 }
@@ -258,157 +468,1350 @@ static int8_t initAlsa(const char *selemname, const char *s_card, snd_mixer_t **
         return ret;
     }
 
-    snd_mixer_selem_id_set_index(sid, 0);
-    snd_mixer_selem_id_set_name(sid, selemname);
+    snd_mixer_selem_id_set_index(sid, 0);
+    snd_mixer_selem_id_set_name(sid, selemname);
+
+    *element = snd_mixer_find_selem(smixer, sid);
+    if (NULL == *element) {
+        hal_err("Unable to find simple control '%s',%i\n", snd_mixer_selem_id_get_name(sid), snd_mixer_selem_id_get_index(sid));
+        dsCloseMixerHandle(&smixer);
+        ret = -1;
+    }
+
+    snd_mixer_selem_id_free(sid);
+
+    if (ret == 0) {
+        *mixer = smixer;
+    }
+
+    return ret;
+}
+
+/*
+ * Fills the gain tables from the element ranges. This is the only place libm is used
+ * for gain conversion; the set/get paths only index and interpolate.
+ */
+static void dsBuildGainTables(dsAudioGainTables_t *tables, long volMin, long volMax, bool hasDbRange,
+        long dbMin, long dbMax, bool usingSoftvol)
+{
+    long levelMin = usingSoftvol ? volMin : volMin / 2;
+    double minNorm = 0.0;
+
+    memset(tables, 0, sizeof(*tables));
+    tables->hasDbRange = hasDbRange;
+    tables->logScale = hasDbRange && ((dbMax - dbMin) > MAX_LINEAR_DB_SCALE * 100);
+    tables->volMin = volMin;
+    tables->volMax = volMax;
+    tables->dbMin = dbMin;
+    tables->dbMax = dbMax;
+
+    if (tables->logScale && (dbMin != SND_CTL_TLV_DB_GAIN_MUTE)) {
+        minNorm = pow(10, (dbMin - dbMax) / 6000.0);
+    }
+
+    for (int i = 0; i < DSAUDIO_GAIN_STEPS; i++) {
+        double fraction = i / 100.0;
+
+        tables->gainToRaw[i] = (long)((fraction * (volMax - volMin)) + volMin);
+        tables->levelToRaw[i] = (long)((fraction * (volMax - levelMin)) + levelMin);
+
+        if (!hasDbRange) {
+            continue;
+        }
+        if (!tables->logScale) {
+            tables->gainToDb[i] = lrint(fraction * (dbMax - dbMin)) + dbMin;
+        } else {
+            double normalized = fraction * (1 - minNorm) + minNorm;
+            tables->gainToDb[i] = (normalized <= 0.0) ? dbMin : (lrint(6000.0 * log10(normalized)) + dbMax);
+        }
+    }
+    tables->valid = true;
+}
+
+/* Interpolated table value for a 0-100 gain/level step. */
+static long dsGainTableValue(const long *table, float gain)
+{
+    int index;
+
+    if (gain <= 0.0f) {
+        return table[0];
+    }
+    if (gain >= 100.0f) {
+        return table[DSAUDIO_GAIN_STEPS - 1];
+    }
+    index = (int)gain;
+    return table[index] + (long)((float)(table[index + 1] - table[index]) * (gain - (float)index));
+}
+
+/* Inverse of dsGainTableValue() for a non-decreasing table; returns a fractional 0-100 step. */
+static float dsGainTableStep(const long *table, long value)
+{
+    size_t lo = 0, hi = DSAUDIO_GAIN_STEPS - 1;
+    long span;
+
+    if (value <= table[lo]) {
+        return 0.0f;
+    }
+    if (value >= table[hi]) {
+        return 100.0f;
+    }
+    while ((hi - lo) > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (table[mid] <= value) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    span = table[hi] - table[lo];
+    return (float)lo + ((span > 0) ? ((float)(value - table[lo]) / (float)span) : 0.0f);
+}
+
+static int dsMixerElemEvent(snd_mixer_elem_t *elem, unsigned int mask)
+{
+    (void)elem;
+    /* Runs from snd_mixer_handle_events() with gMixerSession.mutex held. */
+    if (mask == SND_CTL_EVENT_MASK_REMOVE) {
+        gMixerSession.stale = true;
+    }
+    return 0;
+}
+
+/* Dispatches queued ctl events without blocking so element removal is noticed. */
+static void dsMixerPumpEvents(snd_mixer_t *mixer)
+{
+    struct pollfd pfds[4];
+    unsigned short revents = 0;
+    int count;
+
+    if (mixer == NULL) {
+        return;
+    }
+
+    count = snd_mixer_poll_descriptors_count(mixer);
+    if (count <= 0 || count > (int)(sizeof(pfds) / sizeof(pfds[0]))) {
+        return;
+    }
+    count = snd_mixer_poll_descriptors(mixer, pfds, (unsigned int)count);
+    if (count <= 0 || poll(pfds, (nfds_t)count, 0) <= 0) {
+        return;
+    }
+    if ((snd_mixer_poll_descriptors_revents(mixer, pfds, (unsigned int)count, &revents) == 0) &&
+            (revents & POLLIN)) {
+        snd_mixer_handle_events(mixer);
+    }
+}
+
+/* Caller must hold gMixerSession.mutex. */
+static void dsMixerSessionCloseLocked(void)
+{
+    if ((gMixerSession.mixer != NULL) || (gMixerSession.iec958Mixer != NULL)) {
+        dsAudioMonitorWake();
+    }
+    dsCloseMixerHandle(&gMixerSession.mixer);
+    dsCloseMixerHandle(&gMixerSession.iec958Mixer);
+    gMixerSession.elem = NULL;
+    gMixerSession.iec958Elem = NULL;
+    gMixerSession.iec958Probed = false;
+    gMixerSession.usingSoftvol = false;
+    gMixerSession.gain.valid = false;
+    gMixerSession.card = NULL;
+    gMixerSession.stale = false;
+}
+
+/* Caller must hold gMixerSession.mutex. */
+static int dsMixerSessionOpenLocked(void)
+{
+    const char *s_card = dsGetPreferredAlsaCard();
+
+    if ((dsInitAudioMixerElem(s_card, &gMixerSession.mixer, &gMixerSession.elem,
+            &gMixerSession.usingSoftvol) != 0) || (gMixerSession.elem == NULL)) {
+        dsCloseMixerHandle(&gMixerSession.mixer);
+        gMixerSession.elem = NULL;
+        gMixerSession.usingSoftvol = false;
+        return -1;
+    }
+
+    gMixerSession.card = s_card;
+    snd_mixer_elem_set_callback(gMixerSession.elem, dsMixerElemEvent);
+    dsGetdBRange();
+    hal_info("Mixer session resolved %s control for card %s\n",
+            gMixerSession.usingSoftvol ? ALSA_SOFTVOL_ELEMENT_NAME : ALSA_ELEMENT_NAME, s_card);
+    return 0;
+}
+
+/*
+ * Locks the mixer session and drops the cached elements if ALSA removed them since
+ * the last call. Every dsMixerSessionLock() must be paired with dsMixerSessionUnlock().
+ */
+static void dsMixerSessionLock(void)
+{
+    pthread_mutex_lock(&gMixerSession.mutex);
+    dsMixerPumpEvents(gMixerSession.mixer);
+    dsMixerPumpEvents(gMixerSession.iec958Mixer);
+    if (gMixerSession.stale) {
+        hal_warn("Mixer element on %s was removed; re-resolving.\n",
+                (gMixerSession.card != NULL) ? gMixerSession.card : "(unknown)");
+        dsMixerSessionCloseLocked();
+    }
+}
+
+static void dsMixerSessionUnlock(void)
+{
+    pthread_mutex_unlock(&gMixerSession.mutex);
+}
+
+/* Unlock after a mixer write; refreshes the snapshot so reads see the new value at once. */
+static void dsMixerSessionWriteUnlock(void)
+{
+    dsAudioStateUpdateLocked(false);
+    pthread_mutex_unlock(&gMixerSession.mutex);
+}
+
+/* Returns the cached playback element, resolving it on first use. Caller holds the session lock. */
+static snd_mixer_elem_t *dsMixerSessionElemLocked(bool *usingSoftvol)
+{
+    if ((gMixerSession.elem == NULL) && (dsMixerSessionOpenLocked() != 0)) {
+        if (usingSoftvol != NULL) {
+            *usingSoftvol = false;
+        }
+        return NULL;
+    }
+    if (usingSoftvol != NULL) {
+        *usingSoftvol = gMixerSession.usingSoftvol;
+    }
+    return gMixerSession.elem;
+}
+
+/* Returns the IEC958 simple element used as snd_ctl fallback. Caller holds the session lock. */
+static snd_mixer_elem_t *dsMixerSessionIec958ElemLocked(void)
+{
+    if ((gMixerSession.elem != NULL) && !gMixerSession.usingSoftvol) {
+        return gMixerSession.elem;
+    }
+    if (!gMixerSession.iec958Probed) {
+        gMixerSession.iec958Probed = true;
+        if ((initAlsa(ALSA_ELEMENT_NAME, dsGetPreferredAlsaCard(), &gMixerSession.iec958Mixer,
+                &gMixerSession.iec958Elem) == 0) && (gMixerSession.iec958Elem != NULL)) {
+            snd_mixer_elem_set_callback(gMixerSession.iec958Elem, dsMixerElemEvent);
+        }
+    }
+    return gMixerSession.iec958Elem;
+}
+
+/* Caller holds the session lock. */
+static dsError_t dsMixerGetMuteLocked(snd_mixer_elem_t *mixer_elem, bool usingSoftvol, bool *muted)
+{
+    if (snd_mixer_selem_has_playback_switch(mixer_elem)) {
+        int mute_status;
+        snd_mixer_selem_get_playback_switch(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &mute_status);
+        *muted = !mute_status;
+        return dsERR_NONE;
+    }
+    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
+        long vol = 0;
+        snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &vol);
+        *muted = (vol <= gMixerSession.gain.volMin);
+        return dsERR_NONE;
+    }
+    hal_warn("No playback switch on HDMI card; mute query unsupported.\n");
+    return dsERR_OPERATION_NOT_SUPPORTED;
+}
+
+/* Caller holds the session lock. */
+static dsError_t dsMixerSetMuteLocked(snd_mixer_elem_t *mixer_elem, bool usingSoftvol, bool mute)
+{
+    if (snd_mixer_selem_has_playback_switch(mixer_elem)) {
+        snd_mixer_selem_set_playback_switch_all(mixer_elem, !mute);
+        if (mute) {
+            hal_dbg("Audio Mute success\n");
+        } else {
+            hal_dbg("Audio Unmute success.\n");
+        }
+        return dsERR_NONE;
+    }
+
+    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
+        long min = gMixerSession.gain.volMin, max = gMixerSession.gain.volMax, cur = 0;
+        snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &cur);
+
+        if (mute) {
+            if (cur > min) {
+                _softvolSavedVolume = cur;
+            }
+            snd_mixer_selem_set_playback_volume_all(mixer_elem, min);
+        } else {
+            long target = _softvolSavedVolume;
+            if (target <= min || target > max) {
+                target = min + ((max - min) * 75 / 100);
+            }
+            snd_mixer_selem_set_playback_volume_all(mixer_elem, target);
+        }
+        return dsERR_NONE;
+    }
+
+    hal_warn("No playback switch on HDMI card; mute control unsupported.\n");
+    return dsERR_OPERATION_NOT_SUPPORTED;
+}
+
+/* Caller holds the session lock. */
+static dsError_t dsMixerReadGainLocked(snd_mixer_elem_t *mixer_elem, bool usingSoftvol, float *gain)
+{
+    const dsAudioGainTables_t *tables = &gMixerSession.gain;
+    long value_got;
+
+    if (!tables->valid) {
+        return dsERR_GENERAL;
+    }
+
+    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
+        if (!snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &value_got)) {
+            *gain = (float)(int)(dsGainTableStep(tables->gainToRaw, value_got) + 0.5f);
+            return dsERR_NONE;
+        }
+        return dsERR_GENERAL;
+    }
+
+    if (tables->hasDbRange && !snd_mixer_selem_get_playback_dB(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &value_got))
+    {
+        hal_info("snd_mixer_selem_get_playback_dB Gain in dB %.2f\n", value_got/100.0);
+        if (!tables->logScale)
+        {
+            *gain = dsGainTableStep(tables->gainToDb, value_got);
+        }
+        else
+        {
+            *gain = (float)(int)(dsGainTableStep(tables->gainToDb, value_got) + 0.5f);
+            hal_dbg("Rounded Gain in linear scale %.2f\n", *gain);
+        }
+        return dsERR_NONE;
+    }
+    hal_err("snd_mixer_selem_get_playback_dB error.\n");
+    return dsERR_GENERAL;
+}
+
+/* Caller holds the session lock. */
+static dsError_t dsMixerReadDBLocked(snd_mixer_elem_t *mixer_elem, bool usingSoftvol, float *db)
+{
+    long db_value;
+
+    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem) && gMixerSession.gain.valid) {
+        long vol = 0;
+        snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &vol);
+        *db = dsGainTableStep(gMixerSession.gain.gainToRaw, vol);
+        return dsERR_NONE;
+    }
+
+    if (!snd_mixer_selem_get_playback_dB(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &db_value)) {
+        *db = (float) db_value/100;
+        return dsERR_NONE;
+    }
+    hal_err("snd_mixer_selem_get_playback_dB failed.\n");
+    return dsERR_GENERAL;
+}
+
+/* Caller holds the session lock. */
+static dsError_t dsMixerReadLevelLocked(snd_mixer_elem_t *mixer_elem, bool usingSoftvol, float *level)
+{
+    const dsAudioGainTables_t *tables = &gMixerSession.gain;
+    long vol_value;
+
+    if (tables->valid && !snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &vol_value)) {
+        if (!usingSoftvol && vol_value == tables->volMin) {
+            *level = 0.0f;
+        } else {
+            *level = (float)(int)(dsGainTableStep(tables->levelToRaw, vol_value) + 0.5f);
+        }
+        return dsERR_NONE;
+    }
+    hal_warn("No playback volume control on HDMI card; level query unsupported.\n");
+    return dsERR_OPERATION_NOT_SUPPORTED;
+}
+
+/* Writes a 0-100 gain to the element without touching mute. Caller holds the session lock. */
+static dsError_t dsMixerWriteGainLocked(snd_mixer_elem_t *mixer_elem, bool usingSoftvol, float gain)
+{
+    const dsAudioGainTables_t *tables = &gMixerSession.gain;
+
+    if (!tables->valid) {
+        hal_err("Gain tables not available.\n");
+        return dsERR_GENERAL;
+    }
+    if (gain < 0.0f) {
+        gain = 0.0f;
+    }
+    if (gain > 100.0f) {
+        gain = 100.0f;
+    }
+
+    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
+        snd_mixer_selem_set_playback_volume_all(mixer_elem, dsGainTableValue(tables->gainToRaw, gain));
+        return dsERR_NONE;
+    }
+
+    if (!tables->hasDbRange) {
+        hal_err("No playback dB range on mixer element.\n");
+        return dsERR_GENERAL;
+    }
+    long dbValue = dsGainTableValue(tables->gainToDb, gain);
+    hal_dbg("Setting gain in dB: %.2f \n", dbValue / 100.0);
+    snd_mixer_selem_set_playback_dB_all(mixer_elem, dbValue, 0);
+    return dsERR_NONE;
+}
+
+static dsAudioEncoding_t dsEncodingFromIec958Switch(int iec958_enabled, dsAudioEncoding_t cached)
+{
+    if (!iec958_enabled) {
+        return dsAUDIO_ENC_PCM;
+    }
+
+    /* IEC958 only tells passthrough ON/OFF; preserve AC3/EAC3 when cached. */
+    if (cached == dsAUDIO_ENC_EAC3) {
+        return dsAUDIO_ENC_EAC3;
+    }
+    return dsAUDIO_ENC_AC3;
+}
+
+static bool dsEncodingToIec958Switch(dsAudioEncoding_t encoding, int *iec958_enabled)
+{
+    if (iec958_enabled == NULL) {
+        return false;
+    }
+
+    switch (encoding) {
+        case dsAUDIO_ENC_NONE:
+        case dsAUDIO_ENC_PCM:
+            *iec958_enabled = 0;
+            return true;
+        case dsAUDIO_ENC_AC3:
+        case dsAUDIO_ENC_EAC3:
+            *iec958_enabled = 1;
+            return true;
+        case dsAUDIO_ENC_DISPLAY:
+        default:
+            return false;
+    }
+}
+
+/* Caller holds gIec958Ctl.mutex. */
+static void dsIec958CtlCloseLocked(void)
+{
+    if (gIec958Ctl.value != NULL) {
+        snd_ctl_elem_value_free(gIec958Ctl.value);
+        gIec958Ctl.value = NULL;
+    }
+    if (gIec958Ctl.id != NULL) {
+        snd_ctl_elem_id_free(gIec958Ctl.id);
+        gIec958Ctl.id = NULL;
+    }
+    if (gIec958Ctl.ctl != NULL) {
+        snd_ctl_close(gIec958Ctl.ctl);
+        gIec958Ctl.ctl = NULL;
+    }
+    gIec958Ctl.card = NULL;
+    gIec958Ctl.numid = 0;
+}
+
+/*
+ * Binds the context to s_card: opens ctl, resolves the IEC958 element numid via
+ * snd_ctl_elem_info() and pre-binds the value so later reads are a single ioctl.
+ * Caller holds gIec958Ctl.mutex.
+ */
+static int dsIec958CtlOpenLocked(const char *s_card)
+{
+    snd_ctl_elem_info_t *info = NULL;
+    int ret;
+
+    if ((gIec958Ctl.ctl != NULL) && (gIec958Ctl.card != NULL) && (strcmp(gIec958Ctl.card, s_card) == 0)) {
+        return 0;
+    }
+    dsIec958CtlCloseLocked();
+
+    if ((ret = snd_ctl_open(&gIec958Ctl.ctl, s_card, 0)) < 0) {
+        gIec958Ctl.ctl = NULL;
+        return ret;
+    }
+    if (((ret = snd_ctl_elem_id_malloc(&gIec958Ctl.id)) < 0) ||
+            ((ret = snd_ctl_elem_value_malloc(&gIec958Ctl.value)) < 0)) {
+        dsIec958CtlCloseLocked();
+        return ret;
+    }
+
+    snd_ctl_elem_id_set_interface(gIec958Ctl.id, SND_CTL_ELEM_IFACE_PCM);
+    snd_ctl_elem_id_set_name(gIec958Ctl.id, ALSA_IEC958_CTL_NAME);
+    snd_ctl_elem_id_set_index(gIec958Ctl.id, 0);
+    snd_ctl_elem_id_set_device(gIec958Ctl.id, 0);
+
+    snd_ctl_elem_info_alloca(&info);
+    snd_ctl_elem_info_set_id(info, gIec958Ctl.id);
+    if ((ret = snd_ctl_elem_info(gIec958Ctl.ctl, info)) < 0) {
+        dsIec958CtlCloseLocked();
+        return ret;
+    }
+
+    gIec958Ctl.numid = snd_ctl_elem_info_get_numid(info);
+    snd_ctl_elem_id_clear(gIec958Ctl.id);
+    snd_ctl_elem_id_set_numid(gIec958Ctl.id, gIec958Ctl.numid);
+    snd_ctl_elem_value_set_id(gIec958Ctl.value, gIec958Ctl.id);
+    gIec958Ctl.card = s_card;
+    hal_info("Cached %s ctl on %s (numid %u)\n", ALSA_IEC958_CTL_NAME, s_card, gIec958Ctl.numid);
+    return 0;
+}
+
+/* Drops the cached ctl; the next access re-opens and re-resolves the element. */
+static void dsIec958CtlInvalidate(void)
+{
+    pthread_mutex_lock(&gIec958Ctl.mutex);
+    dsIec958CtlCloseLocked();
+    pthread_mutex_unlock(&gIec958Ctl.mutex);
+}
+
+/* Caller holds gIec958Ctl.mutex; invalidates the context if the card is gone. */
+static int dsIec958CtlReadLocked(snd_aes_iec958_t *iec958)
+{
+    int ret = snd_ctl_elem_read(gIec958Ctl.ctl, gIec958Ctl.value);
+
+    if (ret < 0) {
+        hal_warn("IEC958 ctl read on %s failed: %s\n", gIec958Ctl.card, snd_strerror(ret));
+        dsIec958CtlCloseLocked();
+        return ret;
+    }
+    snd_ctl_elem_value_get_iec958(gIec958Ctl.value, iec958);
+    return 0;
+}
+
+static int dsIec958CtlReadSwitch(const char *s_card, int *iec958_enabled)
+{
+    if ((s_card == NULL) || (iec958_enabled == NULL)) {
+        return -1;
+    }
+
+    snd_aes_iec958_t iec958;
+    int ret;
+
+    pthread_mutex_lock(&gIec958Ctl.mutex);
+    ret = dsIec958CtlOpenLocked(s_card);
+    if (ret == 0) {
+        ret = dsIec958CtlReadLocked(&iec958);
+    }
+    if (ret == 0) {
+        *iec958_enabled = ((iec958.status[0] & IEC958_AES0_NONAUDIO) != 0) ? 1 : 0;
+    }
+    pthread_mutex_unlock(&gIec958Ctl.mutex);
+    return ret;
+}
+
+static int dsIec958CtlWriteSwitch(const char *s_card, int iec958_enabled)
+{
+    if (s_card == NULL) {
+        return -1;
+    }
+
+    snd_aes_iec958_t iec958;
+    int ret;
+
+    pthread_mutex_lock(&gIec958Ctl.mutex);
+    ret = dsIec958CtlOpenLocked(s_card);
+    if (ret == 0) {
+        ret = dsIec958CtlReadLocked(&iec958);
+    }
+    if (ret == 0 && (((iec958.status[0] & IEC958_AES0_NONAUDIO) != 0) == (iec958_enabled != 0))) {
+        /* Already in the requested state; skip the write. */
+        pthread_mutex_unlock(&gIec958Ctl.mutex);
+        return 0;
+    }
+    if (ret == 0) {
+        if (iec958_enabled) {
+            iec958.status[0] |= IEC958_AES0_NONAUDIO;
+        } else {
+            iec958.status[0] &= (unsigned char)~IEC958_AES0_NONAUDIO;
+        }
+        snd_ctl_elem_value_set_iec958(gIec958Ctl.value, &iec958);
+        ret = snd_ctl_elem_write(gIec958Ctl.ctl, gIec958Ctl.value);
+        if (ret < 0) {
+            hal_warn("IEC958 ctl write on %s failed: %s\n", gIec958Ctl.card, snd_strerror(ret));
+            dsIec958CtlCloseLocked();
+        }
+    }
+    pthread_mutex_unlock(&gIec958Ctl.mutex);
+    return ret;
+}
+
+static void dsAudioMonitorWake(void)
+{
+    uint64_t one = 1;
+
+    if (gAudioMonitorCtx.wakeFd < 0) {
+        return;
+    }
+    while (write(gAudioMonitorCtx.wakeFd, &one, sizeof(one)) < 0) {
+        if (errno == EINTR) {
+            continue;
+        }
+        /* EAGAIN means the counter is saturated, so the monitor is already woken. */
+        if (errno != EAGAIN) {
+            hal_err("Audio monitor: wake eventfd write failed: %s\n", strerror(errno));
+        }
+        break;
+    }
+}
+
+static void dsAudioMonitorDrainWake(void)
+{
+    uint64_t value;
+
+    while (read(gAudioMonitorCtx.wakeFd, &value, sizeof(value)) < 0) {
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN) {
+            hal_err("Audio monitor: wake eventfd read failed: %s\n", strerror(errno));
+        }
+        break;
+    }
+}
+
+static bool dsAudioMonitorGetState(dsAudioStateSnapshot_t *state)
+{
+    bool valid;
+
+    pthread_mutex_lock(&gAudioMonitorCtx.stateMutex);
+    valid = gAudioMonitorCtx.stateValid;
+    if (valid) {
+        *state = gAudioMonitorCtx.state;
+    }
+    pthread_mutex_unlock(&gAudioMonitorCtx.stateMutex);
+    return valid;
+}
+
+/*
+ * Rebuilds the mixer-derived part of the snapshot from the cached element.
+ * Caller holds the session lock. Without markValid the snapshot is only refreshed
+ * if the monitor has already published one.
+ */
+static void dsAudioStateUpdateLocked(bool markValid)
+{
+    dsAudioStateSnapshot_t state = {0};
+    snd_mixer_elem_t *mixer_elem = gMixerSession.elem;
+    bool usingSoftvol = gMixerSession.usingSoftvol;
+
+    if (mixer_elem != NULL) {
+        state.muteValid = (dsMixerGetMuteLocked(mixer_elem, usingSoftvol, &state.muted) == dsERR_NONE);
+        state.gainValid = (dsMixerReadGainLocked(mixer_elem, usingSoftvol, &state.gain) == dsERR_NONE);
+        state.dbValid = (dsMixerReadDBLocked(mixer_elem, usingSoftvol, &state.db) == dsERR_NONE);
+        state.levelValid = (dsMixerReadLevelLocked(mixer_elem, usingSoftvol, &state.level) == dsERR_NONE);
+    }
+
+    pthread_mutex_lock(&gAudioMonitorCtx.stateMutex);
+    if (markValid || gAudioMonitorCtx.stateValid) {
+        state.iec958Valid = gAudioMonitorCtx.state.iec958Valid;
+        state.iec958Enabled = gAudioMonitorCtx.state.iec958Enabled;
+        gAudioMonitorCtx.state = state;
+        gAudioMonitorCtx.stateValid = true;
+    }
+    pthread_mutex_unlock(&gAudioMonitorCtx.stateMutex);
+}
+
+static void dsAudioStateSetIec958(int iec958_enabled)
+{
+    pthread_mutex_lock(&gAudioMonitorCtx.stateMutex);
+    if (gAudioMonitorCtx.stateValid) {
+        gAudioMonitorCtx.state.iec958Enabled = iec958_enabled;
+        gAudioMonitorCtx.state.iec958Valid = true;
+    }
+    pthread_mutex_unlock(&gAudioMonitorCtx.stateMutex);
+}
+
+#ifdef DSHAL_ENABLE_ALSA_EXPERIMENTAL
+/*
+ * Re-reads the IEC958 non-audio bit. Returns true and sets *format when it no longer
+ * matches the HAL encoding, i.e. someone outside the HAL changed it. Caller holds the session lock.
+ */
+static bool dsAudioStateUpdateIec958Locked(dsAudioFormat_t *format)
+{
+    int iec958_enabled = 0;
+    bool changed = false;
+
+    if (dsIec958CtlReadSwitch(dsGetPreferredAlsaCard(), &iec958_enabled) != 0) {
+        pthread_mutex_lock(&gAudioMonitorCtx.stateMutex);
+        gAudioMonitorCtx.state.iec958Valid = false;
+        pthread_mutex_unlock(&gAudioMonitorCtx.stateMutex);
+        return false;
+    }
+
+    dsAudioEncoding_t encoding = dsEncodingFromIec958Switch(iec958_enabled, _encoding);
+    if (dsFormatFromEncoding(encoding) != dsFormatFromEncoding(_encoding)) {
+        hal_info("IEC958 non-audio bit changed outside HAL; encoding %d -> %d\n", _encoding, encoding);
+        _encoding = encoding;
+        *format = dsFormatFromEncoding(encoding);
+        changed = true;
+    }
+    dsAudioStateSetIec958(iec958_enabled);
+    return changed;
+}
+
+/*
+ * Programs the IEC958 non-audio bit for the encoding and updates the cached encoding.
+ * Caller holds the session lock.
+ */
+static dsError_t dsApplyEncodingLocked(dsAudioEncoding_t encoding)
+{
+    snd_mixer_elem_t *iec958_elem = NULL;
+    int iec958_enabled = 0;
+
+    if (!dsEncodingToIec958Switch(encoding, &iec958_enabled)) {
+        hal_err("Unsupported encoding(%d) for ALSA experimental path.\n", encoding);
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+
+    /* Prefer snd_ctl path for vc4hdmi0 and fall back to mixer where available. */
+    if (dsIec958CtlWriteSwitch(dsGetPreferredAlsaCard(), iec958_enabled) != 0) {
+        if (((iec958_elem = dsMixerSessionIec958ElemLocked()) != NULL) &&
+                snd_mixer_selem_has_playback_switch(iec958_elem)) {
+            if (snd_mixer_selem_set_playback_switch_all(iec958_elem, iec958_enabled) != 0) {
+                hal_err("Failed to set IEC958 playback switch for encoding(%d).\n", encoding);
+                return dsERR_GENERAL;
+            }
+        } else {
+            hal_err("IEC958 control not available; cannot set encoding(%d).\n", encoding);
+            return dsERR_OPERATION_NOT_SUPPORTED;
+        }
+    }
+
+    _encoding = encoding;
+    dsAudioStateSetIec958(iec958_enabled);
+    return dsERR_NONE;
+}
+
+/* Maps a stereo mode to the encoding that realises it on the IEC958 path. */
+static dsError_t dsEncodingFromStereoMode(dsAudioStereoMode_t mode, dsAudioEncoding_t current,
+        dsAudioEncoding_t *encoding)
+{
+    switch (mode) {
+        case dsAUDIO_STEREO_STEREO:
+            *encoding = dsAUDIO_ENC_PCM;
+            return dsERR_NONE;
+        case dsAUDIO_STEREO_DD:
+            *encoding = dsAUDIO_ENC_AC3;
+            return dsERR_NONE;
+        case dsAUDIO_STEREO_DDPLUS:
+            *encoding = dsAUDIO_ENC_EAC3;
+            return dsERR_NONE;
+        case dsAUDIO_STEREO_PASSTHRU:
+            /* Passthrough: preserve current encoding if AC3/EAC3, else default to AC3 */
+            if (current == dsAUDIO_ENC_AC3 || current == dsAUDIO_ENC_EAC3) {
+                *encoding = current;
+            } else {
+                *encoding = dsAUDIO_ENC_AC3;
+            }
+            return dsERR_NONE;
+        case dsAUDIO_STEREO_MONO: /* No standard ALSA "set mono" API */
+        case dsAUDIO_STEREO_SURROUND:
+        case dsAUDIO_STEREO_UNKNOWN:
+        default:
+            hal_err("Unsupported stereo mode(%d) for ALSA experimental path.\n", mode);
+            return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+}
+#endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
+
+static snd_ctl_t *dsAudioMonitorOpenCtl(void)
+{
+    const char *s_card = dsGetPreferredAlsaCard();
+    snd_ctl_t *ctl = NULL;
+    int ret;
+
+    if ((ret = snd_ctl_open(&ctl, s_card, SND_CTL_NONBLOCK)) < 0) {
+        hal_dbg("Audio monitor: cannot open ctl %s: %s\n", s_card, snd_strerror(ret));
+        return NULL;
+    }
+    if ((ret = snd_ctl_subscribe_events(ctl, 1)) < 0) {
+        hal_err("Audio monitor: cannot subscribe to ctl events on %s: %s\n", s_card, snd_strerror(ret));
+        snd_ctl_close(ctl);
+        return NULL;
+    }
+    hal_info("Audio monitor subscribed to ctl events on %s\n", s_card);
+    return ctl;
+}
+
+/* Drains queued ctl events. Returns false if the card went away and ctl must be reopened. */
+static bool dsAudioMonitorDrainCtl(snd_ctl_t *ctl)
+{
+    snd_ctl_event_t *event;
+    bool alive = true;
+
+    snd_ctl_event_alloca(&event);
+    while (snd_ctl_read(ctl, event) > 0) {
+        if ((snd_ctl_event_get_type(event) == SND_CTL_EVENT_ELEM) &&
+                (snd_ctl_event_elem_get_mask(event) == SND_CTL_EVENT_MASK_REMOVE)) {
+            alive = false;
+        }
+    }
+    return alive;
+}
+
+static void dsAudioSoundWatchClose(void)
+{
+    if (gAudioMonitorCtx.soundMonitor != NULL) {
+        udev_monitor_unref(gAudioMonitorCtx.soundMonitor);
+        gAudioMonitorCtx.soundMonitor = NULL;
+    }
+    if (gAudioMonitorCtx.udev != NULL) {
+        udev_unref(gAudioMonitorCtx.udev);
+        gAudioMonitorCtx.udev = NULL;
+    }
+    gAudioMonitorCtx.soundFd = -1;
+}
+
+static void dsAudioSoundWatchOpen(void)
+{
+    gAudioMonitorCtx.udev = udev_new();
+    if (gAudioMonitorCtx.udev == NULL) {
+        hal_err("Audio monitor: udev_new failed; ALSA card hotplug will not be tracked.\n");
+        return;
+    }
+    gAudioMonitorCtx.soundMonitor = udev_monitor_new_from_netlink(gAudioMonitorCtx.udev, "udev");
+    if ((gAudioMonitorCtx.soundMonitor == NULL) ||
+            (udev_monitor_filter_add_match_subsystem_devtype(gAudioMonitorCtx.soundMonitor, "sound", NULL) < 0) ||
+            (udev_monitor_enable_receiving(gAudioMonitorCtx.soundMonitor) < 0)) {
+        hal_err("Audio monitor: failed to set up sound udev monitor.\n");
+        dsAudioSoundWatchClose();
+        return;
+    }
+    gAudioMonitorCtx.soundFd = udev_monitor_get_fd(gAudioMonitorCtx.soundMonitor);
+    if (gAudioMonitorCtx.soundFd < 0) {
+        dsAudioSoundWatchClose();
+    }
+}
+
+/* Returns true if a sound card or its control device was added, removed or changed. */
+static bool dsAudioSoundWatchDrain(void)
+{
+    struct udev_device *dev;
+    bool cardsChanged = false;
+
+    while ((dev = udev_monitor_receive_device(gAudioMonitorCtx.soundMonitor)) != NULL) {
+        const char *sysname = udev_device_get_sysname(dev);
+        const char *action = udev_device_get_action(dev);
+
+        if ((sysname != NULL) && (action != NULL) &&
+                ((strncmp(sysname, "card", 4) == 0) || (strncmp(sysname, "controlC", 8) == 0)) &&
+                ((strcmp(action, "add") == 0) || (strcmp(action, "remove") == 0) ||
+                 (strcmp(action, "change") == 0))) {
+            hal_info("Sound udev event: %s %s\n", action, sysname);
+            cardsChanged = true;
+        }
+        udev_device_unref(dev);
+    }
+    return cardsChanged;
+}
+
+/* Drops every cached ALSA binding and re-probes the preferred card. */
+static void dsAudioReselectCard(void)
+{
+    const char *previous = atomic_exchange_explicit(&gSelectedAlsaCard, NULL, memory_order_acq_rel);
+
+    dsMixerSessionLock();
+    dsMixerSessionCloseLocked();
+    dsMixerSessionUnlock();
+    dsIec958CtlInvalidate();
+
+    const char *selected = dsGetPreferredAlsaCard();
+    if ((previous == NULL) || (strcmp(previous, selected) != 0)) {
+        hal_info("ALSA HDMI card re-selected: %s -> %s\n", (previous != NULL) ? previous : "(none)", selected);
+    }
+}
+
+static void *dsAudioMonitorThread(void *arg)
+{
+    (void)arg;
+    snd_ctl_t *ctl = NULL;
+    bool refresh = true;
+
+    hal_info("Audio monitor thread started.\n");
+    while (!atomic_load(&gAudioMonitorCtx.stopRequested)) {
+        struct pollfd pfds[DSAUDIO_MONITOR_MAX_FDS];
+        nfds_t nfds = 0;
+        nfds_t ctlBase = 0, ctlCount = 0;
+        nfds_t mixerBase = 0;
+        nfds_t soundIdx = 0;
+        int count;
+
+        if (ctl == NULL) {
+            ctl = dsAudioMonitorOpenCtl();
+            refresh = refresh || (ctl != NULL);
+        }
+
+        if (refresh) {
+            dsAudioFormat_t format = dsAUDIO_FORMAT_NONE;
+            bool formatChanged = false;
+
+            /* Locking pumps pending mixer events so cached selem values are current. */
+            dsMixerSessionLock();
+            (void)dsMixerSessionElemLocked(NULL);
+            dsAudioStateUpdateLocked(true);
+#ifdef DSHAL_ENABLE_ALSA_EXPERIMENTAL
+            formatChanged = dsAudioStateUpdateIec958Locked(&format);
+#endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
+            dsMixerSessionUnlock();
+            refresh = false;
+
+            if (formatChanged && (_halaudioformatCB != NULL)) {
+                _halaudioformatCB(format);
+            }
+        }
+
+        pfds[nfds].fd = gAudioMonitorCtx.wakeFd;
+        pfds[nfds].events = POLLIN;
+        pfds[nfds].revents = 0;
+        nfds++;
+
+        soundIdx = nfds;
+        if (gAudioMonitorCtx.soundFd >= 0) {
+            pfds[nfds].fd = gAudioMonitorCtx.soundFd;
+            pfds[nfds].events = POLLIN;
+            pfds[nfds].revents = 0;
+            nfds++;
+        }
+
+        if (ctl != NULL) {
+            count = snd_ctl_poll_descriptors(ctl, &pfds[nfds], (unsigned int)(DSAUDIO_MONITOR_MAX_FDS - nfds));
+            if (count > 0) {
+                ctlBase = nfds;
+                ctlCount = (nfds_t)count;
+                nfds += ctlCount;
+            }
+        }
+
+        /* Mixer fds are re-collected every pass since the session may have been re-resolved. */
+        pthread_mutex_lock(&gMixerSession.mutex);
+        mixerBase = nfds;
+        if (gMixerSession.mixer != NULL) {
+            count = snd_mixer_poll_descriptors(gMixerSession.mixer, &pfds[nfds],
+                    (unsigned int)(DSAUDIO_MONITOR_MAX_FDS - nfds));
+            if (count > 0) {
+                nfds += (nfds_t)count;
+            }
+        }
+        pthread_mutex_unlock(&gMixerSession.mutex);
+
+        /* Every source has an fd; block until one fires. */
+        count = poll(pfds, nfds, (ctl == NULL && gAudioMonitorCtx.soundFd < 0) ? DSAUDIO_MONITOR_CTL_RETRY_MS : -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            hal_err("Audio monitor poll failed: %s\n", strerror(errno));
+            break;
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            dsAudioMonitorDrainWake();
+        }
+
+        if ((gAudioMonitorCtx.soundFd >= 0) && (pfds[soundIdx].revents & POLLIN) && dsAudioSoundWatchDrain()) {
+            if (ctl != NULL) {
+                snd_ctl_close(ctl);
+                ctl = NULL;
+            }
+            dsAudioReselectCard();
+            refresh = true;
+            /* Descriptors collected above may belong to the closed session. */
+            continue;
+        }
+
+        if (ctlCount > 0) {
+            unsigned short revents = 0;
+            snd_ctl_poll_descriptors_revents(ctl, &pfds[ctlBase], (unsigned int)ctlCount, &revents);
+            if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                hal_warn("Audio monitor: ctl device went away; reopening.\n");
+                snd_ctl_close(ctl);
+                ctl = NULL;
+                dsIec958CtlInvalidate();
+                refresh = true;
+            } else if (revents & POLLIN) {
+                if (!dsAudioMonitorDrainCtl(ctl)) {
+                    snd_ctl_close(ctl);
+                    ctl = NULL;
+                    dsIec958CtlInvalidate();
+                }
+                refresh = true;
+            }
+        }
+
+        for (nfds_t i = mixerBase; i < nfds; i++) {
+            if (pfds[i].revents != 0) {
+                refresh = true;
+                break;
+            }
+        }
+    }
+
+    if (ctl != NULL) {
+        snd_ctl_close(ctl);
+    }
+    hal_info("Audio monitor thread exiting.\n");
+    return NULL;
+}
+
+static void dsAudioMonitorStart(void)
+{
+    if (gAudioMonitorCtx.threadRunning) {
+        return;
+    }
+
+    gAudioMonitorCtx.wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (gAudioMonitorCtx.wakeFd < 0) {
+        hal_err("Audio monitor: eventfd failed: %s\n", strerror(errno));
+        return;
+    }
+
+    dsAudioSoundWatchOpen();
+
+    atomic_store(&gAudioMonitorCtx.stopRequested, false);
+    if (pthread_create(&gAudioMonitorCtx.thread, NULL, dsAudioMonitorThread, NULL) != 0) {
+        hal_err("Audio monitor: failed to create thread.\n");
+        dsAudioSoundWatchClose();
+        close(gAudioMonitorCtx.wakeFd);
+        gAudioMonitorCtx.wakeFd = -1;
+        return;
+    }
+    gAudioMonitorCtx.threadRunning = true;
+}
+
+static void dsAudioMonitorStop(void)
+{
+    if (!gAudioMonitorCtx.threadRunning) {
+        return;
+    }
+
+    atomic_store(&gAudioMonitorCtx.stopRequested, true);
+    dsAudioMonitorWake();
+    pthread_join(gAudioMonitorCtx.thread, NULL);
+    gAudioMonitorCtx.threadRunning = false;
+    dsAudioSoundWatchClose();
 
-    *element = snd_mixer_find_selem(smixer, sid);
-    if (NULL == *element) {
-        hal_err("Unable to find simple control '%s',%i\n", snd_mixer_selem_id_get_name(sid), snd_mixer_selem_id_get_index(sid));
-        dsCloseMixerHandle(&smixer);
-        ret = -1;
-    }
+    close(gAudioMonitorCtx.wakeFd);
+    gAudioMonitorCtx.wakeFd = -1;
 
-    snd_mixer_selem_id_free(sid);
+    pthread_mutex_lock(&gAudioMonitorCtx.stateMutex);
+    gAudioMonitorCtx.stateValid = false;
+    memset(&gAudioMonitorCtx.state, 0, sizeof(gAudioMonitorCtx.state));
+    pthread_mutex_unlock(&gAudioMonitorCtx.stateMutex);
+}
 
-    if (ret == 0) {
-        *mixer = smixer;
-    }
+/* Returns a simple element on the session card by name, or NULL. Caller holds the session lock. */
+static snd_mixer_elem_t *dsMixerSessionFindElemLocked(const char *name)
+{
+    snd_mixer_selem_id_t *sid;
 
-    return ret;
+    if (dsMixerSessionElemLocked(NULL) == NULL || gMixerSession.mixer == NULL) {
+        return NULL;
+    }
+    snd_mixer_selem_id_alloca(&sid);
+    snd_mixer_selem_id_set_index(sid, 0);
+    snd_mixer_selem_id_set_name(sid, name);
+    return snd_mixer_find_selem(gMixerSession.mixer, sid);
 }
 
-static dsAudioEncoding_t dsEncodingFromIec958Switch(int iec958_enabled, dsAudioEncoding_t cached)
+/* Writes a 0-100 position to the ducking element; takes the session lock. */
+static void dsAudioDuckWrite(float position)
 {
-    if (!iec958_enabled) {
-        return dsAUDIO_ENC_PCM;
+    snd_mixer_elem_t *duck_elem;
+    long min = 0, max = 0;
+
+    dsMixerSessionLock();
+    duck_elem = dsMixerSessionFindElemLocked(ALSA_DUCK_ELEMENT_NAME);
+    if (duck_elem != NULL && snd_mixer_selem_has_playback_volume(duck_elem)) {
+        snd_mixer_selem_get_playback_volume_range(duck_elem, &min, &max);
+        snd_mixer_selem_set_playback_volume_all(duck_elem, min + lrintf(position * (float)(max - min) / 100.0f));
     }
+    dsMixerSessionUnlock();
+}
 
-    /* IEC958 only tells passthrough ON/OFF; preserve AC3/EAC3 when cached. */
-    if (cached == dsAUDIO_ENC_EAC3) {
-        return dsAUDIO_ENC_EAC3;
+/* Starts a ramp from the current position to target. Caller holds gAudioDuck.mutex. */
+static void dsAudioDuckSetTargetLocked(float target)
+{
+    if (target == gAudioDuck.target) {
+        return;
     }
-    return dsAUDIO_ENC_AC3;
+    gAudioDuck.target = target;
+    gAudioDuck.stepSize = (target - gAudioDuck.current) / (float)gAudioDuck.rampSteps;
+    pthread_cond_signal(&gAudioDuck.cond);
 }
 
-static bool dsEncodingToIec958Switch(dsAudioEncoding_t encoding, int *iec958_enabled)
+/* 1/100 dB that dsMixerWriteGainLocked() applies for a 0-100 gain. Caller holds the session lock. */
+static bool dsGainToDbLocked(float gain, long *db)
 {
-    if (iec958_enabled == NULL) {
+    const dsAudioGainTables_t *tables = &gMixerSession.gain;
+
+    if (!tables->valid || !tables->hasDbRange) {
         return false;
     }
+    if (gMixerSession.usingSoftvol) {
+        /* Softvol positions are linear in dB. */
+        *db = tables->dbMin + lrintf(gain * (float)(tables->dbMax - tables->dbMin) / 100.0f);
+    } else {
+        *db = dsGainTableValue(tables->gainToDb, gain);
+    }
+    return true;
+}
 
-    switch (encoding) {
-        case dsAUDIO_ENC_NONE:
-        case dsAUDIO_ENC_PCM:
-            *iec958_enabled = 0;
-            return true;
-        case dsAUDIO_ENC_AC3:
-        case dsAUDIO_ENC_EAC3:
-            *iec958_enabled = 1;
-            return true;
-        case dsAUDIO_ENC_DISPLAY:
-        default:
-            return false;
+/*
+ * SoftDuck position that attenuates a userGain output down to what gain level would
+ * give on its own. The stages add in dB, so the duck stage takes level_dB - userGain_dB.
+ * Caller holds the session lock.
+ */
+static float dsAudioDuckAbsolutePositionLocked(float level, float userGain)
+{
+    snd_mixer_elem_t *duck_elem = dsMixerSessionFindElemLocked(ALSA_DUCK_ELEMENT_NAME);
+    long levelDb = 0, userDb = 0, duckMin = 0, duckMax = 0;
+    float position;
+
+    if (duck_elem != NULL && dsGainToDbLocked(level, &levelDb) && dsGainToDbLocked(userGain, &userDb) &&
+            snd_mixer_selem_get_playback_dB_range(duck_elem, &duckMin, &duckMax) == 0 && duckMax > duckMin) {
+        position = (float)(duckMax + levelDb - userDb - duckMin) * 100.0f / (float)(duckMax - duckMin);
+    } else {
+        /* No dB ranges: both stages are softvols over the same dB-linear span (asound.conf). */
+        position = 100.0f + level - userGain;
     }
+    return (position < 0.0f) ? 0.0f : (position > 100.0f) ? 100.0f : position;
 }
 
-static int dsIec958CtlReadSwitch(const char *s_card, int *iec958_enabled)
+/*
+ * Recomputes the ducking target from the request and the current user gain, so an
+ * absolute duck level keeps meaning "output at most this loud" after dsSetAudioGain().
+ * Caller holds the session lock.
+ */
+static void dsAudioDuckUpdateTargetLocked(void)
 {
-    if ((s_card == NULL) || (iec958_enabled == NULL)) {
-        return -1;
+    float userGain = 100.0f;
+    float target = 100.0f;
+
+    if (!gAudioDuck.threadRunning) {
+        return;
+    }
+    pthread_mutex_lock(&gAudioDuck.mutex);
+    if (gAudioDuck.active) {
+        if (gAudioDuck.type == dsAUDIO_DUCKINGTYPE_RELATIVE) {
+            target = (float)gAudioDuck.level;
+        } else {
+            if (gMixerSession.elem != NULL) {
+                (void)dsMixerReadGainLocked(gMixerSession.elem, gMixerSession.usingSoftvol, &userGain);
+            }
+            if (userGain > (float)gAudioDuck.level) {
+                target = dsAudioDuckAbsolutePositionLocked((float)gAudioDuck.level, userGain);
+            }
+        }
     }
+    dsAudioDuckSetTargetLocked(target);
+    pthread_mutex_unlock(&gAudioDuck.mutex);
+}
 
-    snd_ctl_t *ctl = NULL;
-    snd_ctl_elem_id_t *id = NULL;
-    snd_ctl_elem_value_t *value = NULL;
-    snd_aes_iec958_t iec958;
-    int ret;
+static void *dsAudioDuckThread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&gAudioDuck.mutex);
+    while (!gAudioDuck.stopRequested) {
+        if (gAudioDuck.current == gAudioDuck.target) {
+            pthread_cond_wait(&gAudioDuck.cond, &gAudioDuck.mutex);
+            continue;
+        }
 
-    ret = snd_ctl_open(&ctl, s_card, 0);
-    if (ret < 0) {
-        return ret;
+        float next = gAudioDuck.current + gAudioDuck.stepSize;
+        if ((gAudioDuck.stepSize >= 0.0f) ? (next >= gAudioDuck.target) : (next <= gAudioDuck.target)) {
+            next = gAudioDuck.target;
+        }
+        gAudioDuck.current = next;
+        pthread_mutex_unlock(&gAudioDuck.mutex);
+
+        dsAudioDuckWrite(next);
+
+        pthread_mutex_lock(&gAudioDuck.mutex);
+        if (gAudioDuck.current != gAudioDuck.target) {
+            struct timespec deadline;
+            int rc = 0;
+
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += (long)gAudioDuck.stepIntervalMs * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            while (!gAudioDuck.stopRequested && rc != ETIMEDOUT) {
+                rc = pthread_cond_timedwait(&gAudioDuck.cond, &gAudioDuck.mutex, &deadline);
+            }
+        }
     }
+    pthread_mutex_unlock(&gAudioDuck.mutex);
+    return NULL;
+}
 
-    if ((ret = snd_ctl_elem_id_malloc(&id)) < 0) {
-        snd_ctl_close(ctl);
-        return ret;
+static int dsAudioDuckEnvInt(const char *name, int def, int min, int max)
+{
+    const char *value = getenv(name);
+    char *end = NULL;
+    long parsed;
+
+    if (value == NULL || *value == '\0') {
+        return def;
+    }
+    parsed = strtol(value, &end, 10);
+    if (*end != '\0' || parsed < min || parsed > max) {
+        hal_warn("Ignoring %s=%s; using %d.\n", name, value, def);
+        return def;
     }
+    return (int)parsed;
+}
 
-    if ((ret = snd_ctl_elem_value_malloc(&value)) < 0) {
-        snd_ctl_elem_id_free(id);
-        snd_ctl_close(ctl);
-        return ret;
+static void dsAudioDuckStart(void)
+{
+    pthread_condattr_t attr;
+
+    if (gAudioDuck.threadRunning) {
+        return;
     }
 
-    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_PCM);
-    snd_ctl_elem_id_set_name(id, ALSA_IEC958_CTL_NAME);
-    snd_ctl_elem_id_set_index(id, 0);
-    snd_ctl_elem_id_set_device(id, 0);
+    gAudioDuck.rampSteps = dsAudioDuckEnvInt("DSHAL_AUDIO_DUCK_RAMP_STEPS", DSAUDIO_DUCK_RAMP_STEPS, 1, 1000);
+    gAudioDuck.stepIntervalMs = dsAudioDuckEnvInt("DSHAL_AUDIO_DUCK_STEP_MS", DSAUDIO_DUCK_STEP_MS, 1, 1000);
+    gAudioDuck.active = false;
+    gAudioDuck.current = 100.0f;
+    gAudioDuck.target = 100.0f;
+    gAudioDuck.stepSize = 0.0f;
+    gAudioDuck.stopRequested = false;
 
-    snd_ctl_elem_value_set_id(value, id);
-    ret = snd_ctl_elem_read(ctl, value);
-    if (ret == 0) {
-        snd_ctl_elem_value_get_iec958(value, &iec958);
-        *iec958_enabled = ((iec958.status[0] & IEC958_AES0_NONAUDIO) != 0) ? 1 : 0;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&gAudioDuck.cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    /* Undo any attenuation left behind by a previous process. */
+    dsAudioDuckWrite(100.0f);
+
+    if (pthread_create(&gAudioDuck.thread, NULL, dsAudioDuckThread, NULL) != 0) {
+        hal_err("Audio ducking: failed to create ramp thread.\n");
+        pthread_cond_destroy(&gAudioDuck.cond);
+        return;
+    }
+    gAudioDuck.threadRunning = true;
+}
+
+static void dsAudioDuckStop(void)
+{
+    if (!gAudioDuck.threadRunning) {
+        return;
     }
 
-    snd_ctl_elem_value_free(value);
-    snd_ctl_elem_id_free(id);
-    snd_ctl_close(ctl);
-    return ret;
+    pthread_mutex_lock(&gAudioDuck.mutex);
+    gAudioDuck.stopRequested = true;
+    pthread_cond_signal(&gAudioDuck.cond);
+    pthread_mutex_unlock(&gAudioDuck.mutex);
+    pthread_join(gAudioDuck.thread, NULL);
+    pthread_cond_destroy(&gAudioDuck.cond);
+    gAudioDuck.threadRunning = false;
+    dsAudioDuckWrite(100.0f);
 }
 
-static int dsIec958CtlWriteSwitch(const char *s_card, int iec958_enabled)
+/* Caller holds gAudioDelayMutex. */
+static int dsAudioDelayCtlOpenLocked(const char *name, snd_ctl_t **ctl, snd_ctl_elem_id_t *id,
+        snd_ctl_elem_value_t *value)
 {
+    const char *s_card = dsGetPreferredAlsaCard();
+    int ret;
+
     if (s_card == NULL) {
-        return -1;
+        return -ENODEV;
+    }
+    ret = snd_ctl_open(ctl, s_card, 0);
+    if (ret < 0) {
+        hal_warn("snd_ctl_open(%s) failed: %s\n", s_card, snd_strerror(ret));
+        return ret;
     }
+    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_MIXER);
+    snd_ctl_elem_id_set_name(id, name);
+    snd_ctl_elem_value_set_id(value, id);
+    return 0;
+}
 
+/* Reads a delay element in ms; -ENOENT if the HAL has not created it on this card yet. */
+static int dsAudioDelayCtlGetLocked(const char *name, uint32_t *valueMs)
+{
     snd_ctl_t *ctl = NULL;
-    snd_ctl_elem_id_t *id = NULL;
-    snd_ctl_elem_value_t *value = NULL;
-    snd_aes_iec958_t iec958;
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_value_t *value;
     int ret;
 
-    ret = snd_ctl_open(&ctl, s_card, 0);
+    snd_ctl_elem_id_alloca(&id);
+    snd_ctl_elem_value_alloca(&value);
+    ret = dsAudioDelayCtlOpenLocked(name, &ctl, id, value);
     if (ret < 0) {
         return ret;
     }
-
-    if ((ret = snd_ctl_elem_id_malloc(&id)) < 0) {
-        snd_ctl_close(ctl);
-        return ret;
+    ret = snd_ctl_elem_read(ctl, value);
+    if (ret == 0) {
+        long ms = snd_ctl_elem_value_get_integer(value, 0);
+        *valueMs = (ms < 0) ? 0 : (uint32_t)ms;
     }
+    snd_ctl_close(ctl);
+    return ret;
+}
 
-    if ((ret = snd_ctl_elem_value_malloc(&value)) < 0) {
-        snd_ctl_elem_id_free(id);
-        snd_ctl_close(ctl);
+/* Writes a delay element in ms, creating it on the card if needed. */
+static int dsAudioDelayCtlSetLocked(const char *name, uint32_t valueMs)
+{
+    snd_ctl_t *ctl = NULL;
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_value_t *value;
+    int ret;
+
+    snd_ctl_elem_id_alloca(&id);
+    snd_ctl_elem_value_alloca(&value);
+    ret = dsAudioDelayCtlOpenLocked(name, &ctl, id, value);
+    if (ret < 0) {
         return ret;
     }
-
-    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_PCM);
-    snd_ctl_elem_id_set_name(id, ALSA_IEC958_CTL_NAME);
-    snd_ctl_elem_id_set_index(id, 0);
-    snd_ctl_elem_id_set_device(id, 0);
-
-    snd_ctl_elem_value_set_id(value, id);
     ret = snd_ctl_elem_read(ctl, value);
-    if (ret == 0) {
-        snd_ctl_elem_value_get_iec958(value, &iec958);
-        if (iec958_enabled) {
-            iec958.status[0] |= IEC958_AES0_NONAUDIO;
-        } else {
-            iec958.status[0] &= (unsigned char)~IEC958_AES0_NONAUDIO;
+    if (ret == -ENOENT) {
+        ret = snd_ctl_elem_add_integer(ctl, id, 1, 0, DSAUDIO_DELAY_MAX_MS, 1);
+        if (ret == -EBUSY || ret == -EEXIST) {
+            /* Another HAL process created it between the read and the add; use it. */
+            ret = snd_ctl_elem_read(ctl, value);
         }
-        snd_ctl_elem_value_set_iec958(value, &iec958);
+        if (ret < 0) {
+            hal_err("Failed to create ctl element %s: %s\n", name, snd_strerror(ret));
+        }
+    }
+    if (ret == 0) {
+        snd_ctl_elem_value_set_integer(value, 0, valueMs);
         ret = snd_ctl_elem_write(ctl, value);
+        /* snd_ctl_elem_write() returns 1 when the value changed. */
+        ret = (ret < 0) ? ret : 0;
+    }
+    if (ret < 0) {
+        hal_err("Failed to write ctl element %s: %s\n", name, snd_strerror(ret));
     }
-
-    snd_ctl_elem_value_free(value);
-    snd_ctl_elem_id_free(id);
     snd_ctl_close(ctl);
     return ret;
 }
 
+/*
+ * Syncs the delay elements with the cached values at init. Elements that already exist
+ * (kept by the kernel across HAL restarts) win; missing ones are created from the cache.
+ */
+static void dsAudioDelayRestore(void)
+{
+    pthread_mutex_lock(&gAudioDelayMutex);
+    if (dsAudioDelayCtlGetLocked(DSAUDIO_DELAY_CTL_NAME, &_audioDelayMs) != 0) {
+        dsAudioDelayCtlSetLocked(DSAUDIO_DELAY_CTL_NAME, _audioDelayMs);
+    }
+    if (dsAudioDelayCtlGetLocked(DSAUDIO_DELAY_OFFSET_CTL_NAME, &_audioDelayOffsetMs) != 0) {
+        dsAudioDelayCtlSetLocked(DSAUDIO_DELAY_OFFSET_CTL_NAME, _audioDelayOffsetMs);
+    }
+    hal_info("Audio delay %u ms, offset %u ms\n", _audioDelayMs, _audioDelayOffsetMs);
+    pthread_mutex_unlock(&gAudioDelayMutex);
+}
+
 /**
  * @brief Initializes the audio port sub-system of Device Settings HAL.
  *
@@ -462,30 +1865,39 @@ dsError_t dsAudioPortInit()
     hal_info("Audio SPDIF m_IsEnabled: %d\n", _AOPHandles[dsAUDIOPORT_TYPE_SPDIF][0].m_IsEnabled);
 
     /* HDMI audio status is now managed via DRM/inotify watcher in display module */
-    dsGetdBRange();
+    dsMixerSessionLock();
+    if (dsMixerSessionElemLocked(NULL) == NULL) {
+        hal_warn("No mixer control resolved at init; will retry on first use.\n");
+    }
+    dsMixerSessionUnlock();
+    dsAudioDelayRestore();
+    dsAudioMonitorStart();
+    dsAudioDuckStart();
     _bIsAudioInitialized = true;
     return ret;
 }
 
+/*
+ * Queries the volume and dB ranges of the session element once and builds the gain
+ * tables used by the gain/dB/level APIs. Caller holds the session lock.
+ */
 static void dsGetdBRange()
 {
     hal_info("invoked.\n");
-    long min_dB_value, max_dB_value;
-    const char *s_card = dsGetPreferredAlsaCard();
-    bool usingSoftvol = false;
-    snd_mixer_t *mixer = NULL;
-    snd_mixer_elem_t *mixer_elem = NULL;
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0) {
-        hal_err("failed to initialize alsa!\n");
-        dsCloseMixerHandle(&mixer);
-        return;
-    }
+    long min_dB_value = 0, max_dB_value = 0;
+    long vol_min = 0, vol_max = 0;
+    snd_mixer_elem_t *mixer_elem = gMixerSession.elem;
+    bool usingSoftvol = gMixerSession.usingSoftvol;
+    bool hasDbRange;
+
+    gMixerSession.gain.valid = false;
     if (mixer_elem == NULL) {
-        hal_err("initAlsa returned mixer_elem as NULL!\n");
-        dsCloseMixerHandle(&mixer);
+        hal_err("failed to initialize alsa!\n");
         return;
     }
-    if (!snd_mixer_selem_get_playback_dB_range(mixer_elem, &min_dB_value, &max_dB_value)) {
+
+    hasDbRange = (snd_mixer_selem_get_playback_dB_range(mixer_elem, &min_dB_value, &max_dB_value) == 0);
+    if (hasDbRange) {
         dBmax = (float) max_dB_value/100;
         dBmin = (float) min_dB_value/100;
     } else if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
@@ -494,7 +1906,12 @@ static void dsGetdBRange()
     } else {
         hal_err("snd_mixer_selem_get_playback_dB_range failed.\n");
     }
-    dsCloseMixerHandle(&mixer);
+    if (snd_mixer_selem_has_playback_volume(mixer_elem)) {
+        snd_mixer_selem_get_playback_volume_range(mixer_elem, &vol_min, &vol_max);
+    }
+
+    dsBuildGainTables(&gMixerSession.gain, vol_min, vol_max, hasDbRange, min_dB_value, max_dB_value,
+            usingSoftvol);
 }
 
 /**
@@ -547,16 +1964,23 @@ dsError_t dsGetAudioEncoding(intptr_t handle, dsAudioEncoding_t *encoding)
 #ifndef DSHAL_ENABLE_ALSA_EXPERIMENTAL
     *encoding = _encoding;
 #else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
-    const char *s_card = dsGetPreferredAlsaCard();
-    snd_mixer_t *mixer = NULL;
+    const char *s_card = NULL;
     snd_mixer_elem_t *iec958_elem = NULL;
     int iec958_enabled = 0;
+    dsAudioStateSnapshot_t state;
+
+    if (dsAudioMonitorGetState(&state) && state.iec958Valid) {
+        *encoding = dsEncodingFromIec958Switch(state.iec958Enabled, _encoding);
+        return dsERR_NONE;
+    }
 
+    s_card = dsGetPreferredAlsaCard();
+    dsMixerSessionLock();
     /* vc4hdmi0 exposes IEC958 primarily via snd_ctl (matches amixer controls/contents). */
     if (dsIec958CtlReadSwitch(s_card, &iec958_enabled) == 0) {
         *encoding = dsEncodingFromIec958Switch(iec958_enabled, _encoding);
         _encoding = *encoding;
-    } else if ((initAlsa("IEC958", s_card, &mixer, &iec958_elem) == 0) && (iec958_elem != NULL) &&
+    } else if (((iec958_elem = dsMixerSessionIec958ElemLocked()) != NULL) &&
             snd_mixer_selem_has_playback_switch(iec958_elem)) {
         if (snd_mixer_selem_get_playback_switch(iec958_elem, SND_MIXER_SCHN_FRONT_LEFT,
                 &iec958_enabled) == 0) {
@@ -570,7 +1994,7 @@ dsError_t dsGetAudioEncoding(intptr_t handle, dsAudioEncoding_t *encoding)
         *encoding = _encoding;
         hal_warn("IEC958 control not available; returning cached encoding (%d).\n", *encoding);
     }
-    dsCloseMixerHandle(&mixer);
+    dsMixerSessionUnlock();
 #endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
     return dsERR_NONE;
 }
@@ -663,10 +2087,8 @@ dsError_t dsGetStereoMode(intptr_t handle, dsAudioStereoMode_t *stereoMode)
 #ifndef DSHAL_ENABLE_ALSA_EXPERIMENTAL
     *stereoMode = _stereoModeHDMI;
 #else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
-    const char *s_card = dsGetPreferredAlsaCard();
-    const char *element_name = ALSA_ELEMENT_NAME;
-    snd_mixer_t *mixer = NULL;
     snd_mixer_elem_t *mixer_elem = NULL;
+    bool isMono = false;
     dsAudioEncoding_t encoding = dsAUDIO_ENC_PCM;
     dsError_t ret = dsGetAudioEncoding(handle, &encoding);
 
@@ -675,12 +2097,14 @@ dsError_t dsGetStereoMode(intptr_t handle, dsAudioStereoMode_t *stereoMode)
         return ret;
     }
 
-    if ((initAlsa(element_name, s_card, &mixer, &mixer_elem) == 0) && (mixer_elem != NULL) &&
-            snd_mixer_selem_is_playback_mono(mixer_elem)) {
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionIec958ElemLocked();
+    isMono = (mixer_elem != NULL) && snd_mixer_selem_is_playback_mono(mixer_elem);
+    dsMixerSessionUnlock();
+    if (isMono) {
         *stereoMode = dsAUDIO_STEREO_MONO;
         _stereoModeHDMI = *stereoMode;
         hal_info("Audio is Mono; returning %d\n", *stereoMode);
-        dsCloseMixerHandle(&mixer);
         return dsERR_NONE;
     }
 
@@ -705,7 +2129,6 @@ dsError_t dsGetStereoMode(intptr_t handle, dsAudioStereoMode_t *stereoMode)
 
     _stereoModeHDMI = *stereoMode;
     hal_info("resolved stereo mode - returning %d\n", *stereoMode);
-    dsCloseMixerHandle(&mixer);
 #endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
     return dsERR_NONE;
 }
@@ -790,37 +2213,26 @@ dsError_t dsIsAudioMute(intptr_t handle, bool *muted)
         hal_err("Invalid parameters; handle(%p) or muted(%p).\n", handle, muted);
         return dsERR_INVALID_PARAM;
     }
-    const char *s_card = dsGetPreferredAlsaCard();
+    dsAudioStateSnapshot_t state;
+    if (dsAudioMonitorGetState(&state) && state.muteValid) {
+        *muted = state.muted;
+        return dsERR_NONE;
+    }
+
     bool usingSoftvol = false;
-    snd_mixer_t *mixer = NULL;
     snd_mixer_elem_t *mixer_elem = NULL;
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0) {
-        hal_warn("ALSA mixer not available on HDMI card; mute query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
+    dsError_t ret;
+
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
     if (mixer_elem == NULL) {
-        hal_warn("No simple mixer control on HDMI card; mute query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
-    if (snd_mixer_selem_has_playback_switch(mixer_elem)) {
-        int mute_status;
-        snd_mixer_selem_get_playback_switch(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &mute_status);
-        *muted = !mute_status;
-    } else if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
-        long vol = 0, min = 0, max = 0;
-        snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &vol);
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-        (void)max;
-        *muted = (vol <= min);
-    } else {
-        hal_warn("No playback switch on HDMI card; mute query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
+        hal_warn("ALSA mixer not available on HDMI card; mute query unsupported.\n");
+        dsMixerSessionUnlock();
         return dsERR_OPERATION_NOT_SUPPORTED;
     }
-    dsCloseMixerHandle(&mixer);
-    return dsERR_NONE;
+    ret = dsMixerGetMuteLocked(mixer_elem, usingSoftvol, muted);
+    dsMixerSessionUnlock();
+    return ret;
 }
 
 /**
@@ -856,55 +2268,20 @@ dsError_t dsSetAudioMute(intptr_t handle, bool mute)
         hal_err("Invalid parameter; handle(%p).\n", handle);
         return dsERR_INVALID_PARAM;
     }
-    const char *s_card = dsGetPreferredAlsaCard();
     bool usingSoftvol = false;
-    snd_mixer_t *mixer = NULL;
     snd_mixer_elem_t *mixer_elem = NULL;
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0) {
-        hal_warn("ALSA mixer not available on HDMI card; mute control unsupported.\n");
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
+    dsError_t ret;
+
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
     if (mixer_elem == NULL) {
-        hal_warn("No simple mixer control on HDMI card; mute control unsupported.\n");
-        dsCloseMixerHandle(&mixer);
+        hal_warn("ALSA mixer not available on HDMI card; mute control unsupported.\n");
+        dsMixerSessionUnlock();
         return dsERR_OPERATION_NOT_SUPPORTED;
     }
-    if (snd_mixer_selem_has_playback_switch(mixer_elem)) {
-        snd_mixer_selem_set_playback_switch_all(mixer_elem, !mute);
-        if (mute) {
-            hal_dbg("Audio Mute success\n");
-        } else {
-            hal_dbg("Audio Unmute success.\n");
-        }
-        dsCloseMixerHandle(&mixer);
-        return dsERR_NONE;
-    }
-
-    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
-        long min = 0, max = 0, cur = 0;
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-        snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &cur);
-
-        if (mute) {
-            if (cur > min) {
-                _softvolSavedVolume = cur;
-            }
-            snd_mixer_selem_set_playback_volume_all(mixer_elem, min);
-        } else {
-            long target = _softvolSavedVolume;
-            if (target <= min || target > max) {
-                target = min + ((max - min) * 75 / 100);
-            }
-            snd_mixer_selem_set_playback_volume_all(mixer_elem, target);
-        }
-        dsCloseMixerHandle(&mixer);
-        return dsERR_NONE;
-    }
-
-    hal_warn("No playback switch on HDMI card; mute control unsupported.\n");
-    dsCloseMixerHandle(&mixer);
-    return dsERR_OPERATION_NOT_SUPPORTED;
+    ret = dsMixerSetMuteLocked(mixer_elem, usingSoftvol, mute);
+    dsMixerSessionWriteUnlock();
+    return ret;
 }
 
 /**
@@ -1032,65 +2409,29 @@ dsError_t dsGetAudioGain(intptr_t handle, float *gain)
 
     if (!dsAudioIsValidHandle(handle) || gain == NULL) {
         hal_err("Invalid parameters; handle(%p) or gain(%p).\n", handle, gain);
-        return dsERR_INVALID_PARAM;
-    }
-
-    long value_got;
-    const char *s_card = dsGetPreferredAlsaCard();
-    bool usingSoftvol = false;
-    long vol_min = 0, vol_max = 0;
-    double normalized= 0, min_norm = 0;
-    snd_mixer_t *mixer = NULL;
-    snd_mixer_elem_t *mixer_elem;
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0) {
-        hal_warn("ALSA mixer not available on HDMI card; gain query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
-
-    if (mixer_elem == NULL) {
-        hal_warn("No simple mixer control on HDMI card; gain query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
-
-    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &vol_min, &vol_max);
-        if (!snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &value_got)) {
-            *gain = round((float)((value_got - vol_min) * 100.0 / (vol_max - vol_min)));
-            dsCloseMixerHandle(&mixer);
-            return dsERR_NONE;
-        }
-        dsCloseMixerHandle(&mixer);
-        return dsERR_GENERAL;
-    }
-
-    snd_mixer_selem_get_playback_dB_range(mixer_elem, &vol_min, &vol_max);
-    if (!snd_mixer_selem_get_playback_dB(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &value_got))
-    {
-        hal_info("snd_mixer_selem_get_playback_dB Gain in dB %.2f\n", value_got/100.0);
-        if ((vol_max - vol_min) <= MAX_LINEAR_DB_SCALE * 100)
-        {
-            *gain = (value_got - vol_min) / (double)(vol_max - vol_min);
-        }
-        else
-        {
-            normalized = pow(10, (value_got - vol_max) / 6000.0);
+        return dsERR_INVALID_PARAM;
+    }
 
-            if (vol_min != SND_CTL_TLV_DB_GAIN_MUTE)
-            {
-                min_norm = pow(10, (vol_min - vol_max) / 6000.0);
-                normalized = (normalized - min_norm) / (1 - min_norm);
-            }
-            *gain = (float)(((int)(100.0f * normalized + 0.5f))/1.0f);
-            hal_dbg("Rounded Gain in linear scale %.2f\n", *gain);
-        }
-        dsCloseMixerHandle(&mixer);
+    dsAudioStateSnapshot_t state;
+    if (dsAudioMonitorGetState(&state) && state.gainValid) {
+        *gain = state.gain;
         return dsERR_NONE;
     }
-    hal_err("snd_mixer_selem_get_playback_dB error.\n");
-    dsCloseMixerHandle(&mixer);
-    return dsERR_GENERAL;
+
+    bool usingSoftvol = false;
+    snd_mixer_elem_t *mixer_elem = NULL;
+    dsError_t ret;
+
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
+    if (mixer_elem == NULL) {
+        hal_warn("ALSA mixer not available on HDMI card; gain query unsupported.\n");
+        dsMixerSessionUnlock();
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    ret = dsMixerReadGainLocked(mixer_elem, usingSoftvol, gain);
+    dsMixerSessionUnlock();
+    return ret;
 }
 
 dsError_t dsGetAudioDB(intptr_t handle, float *db)
@@ -1106,39 +2447,26 @@ dsError_t dsGetAudioDB(intptr_t handle, float *db)
         return dsERR_INVALID_PARAM;
     }
 
-    long db_value;
-    const char *s_card = dsGetPreferredAlsaCard();
-    bool usingSoftvol = false;
+    dsAudioStateSnapshot_t state;
+    if (dsAudioMonitorGetState(&state) && state.dbValid) {
+        *db = state.db;
+        return dsERR_NONE;
+    }
 
-    snd_mixer_t *mixer = NULL;
+    bool usingSoftvol = false;
     snd_mixer_elem_t *mixer_elem = NULL;
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0) {
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
+    dsError_t ret;
+
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
     if (mixer_elem == NULL) {
         hal_warn("No simple mixer control on HDMI card; dB query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionUnlock();
         return dsERR_OPERATION_NOT_SUPPORTED;
     }
-
-    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
-        long vol = 0, min = 0, max = 0;
-        snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &vol);
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-        *db = (float)((vol - min) * 100.0 / (max - min));
-        dsCloseMixerHandle(&mixer);
-        return dsERR_NONE;
-    }
-
-    if (!snd_mixer_selem_get_playback_dB(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &db_value)) {
-        *db = (float) db_value/100;
-        dsCloseMixerHandle(&mixer);
-        return dsERR_NONE;
-    }
-    hal_err("snd_mixer_selem_get_playback_dB failed.\n");
-    dsCloseMixerHandle(&mixer);
-    return dsERR_GENERAL;
+    ret = dsMixerReadDBLocked(mixer_elem, usingSoftvol, db);
+    dsMixerSessionUnlock();
+    return ret;
 }
 
 /**
@@ -1175,34 +2503,26 @@ dsError_t dsGetAudioLevel(intptr_t handle, float *level)
         return dsERR_INVALID_PARAM;
     }
 
-    long vol_value, min, max;
-    const char *s_card = dsGetPreferredAlsaCard();
-    bool usingSoftvol = false;
+    dsAudioStateSnapshot_t state;
+    if (dsAudioMonitorGetState(&state) && state.levelValid) {
+        *level = state.level;
+        return dsERR_NONE;
+    }
 
-    snd_mixer_t *mixer = NULL;
+    bool usingSoftvol = false;
     snd_mixer_elem_t *mixer_elem = NULL;
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0) {
-        hal_warn("ALSA mixer not available on HDMI card; level query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
+    dsError_t ret;
+
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
     if (mixer_elem == NULL) {
-        hal_warn("No simple mixer control on HDMI card; level query unsupported.\n");
-        dsCloseMixerHandle(&mixer);
+        hal_warn("ALSA mixer not available on HDMI card; level query unsupported.\n");
+        dsMixerSessionUnlock();
         return dsERR_OPERATION_NOT_SUPPORTED;
     }
-    if (!snd_mixer_selem_get_playback_volume(mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &vol_value)) {
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-        if (!usingSoftvol && min != vol_value){
-            min=min/2;
-        }
-        *level = round((float)((vol_value - min)*100.0/(max - min)));
-        dsCloseMixerHandle(&mixer);
-        return dsERR_NONE;
-    }
-    hal_warn("No playback volume control on HDMI card; level query unsupported.\n");
-    dsCloseMixerHandle(&mixer);
-    return dsERR_OPERATION_NOT_SUPPORTED;
+    ret = dsMixerReadLevelLocked(mixer_elem, usingSoftvol, level);
+    dsMixerSessionUnlock();
+    return ret;
 }
 
 dsError_t dsGetAudioMaxDB(intptr_t handle, float *maxDb)
@@ -1281,34 +2601,12 @@ dsError_t dsSetAudioEncoding(intptr_t handle, dsAudioEncoding_t encoding)
 #ifndef DSHAL_ENABLE_ALSA_EXPERIMENTAL
     _encoding = encoding;
 #else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
-    const char *s_card = dsGetPreferredAlsaCard();
-    snd_mixer_t *mixer = NULL;
-    snd_mixer_elem_t *iec958_elem = NULL;
-    int iec958_enabled = 0;
-
-    if (!dsEncodingToIec958Switch(encoding, &iec958_enabled)) {
-        hal_err("Unsupported encoding(%d) for ALSA experimental path.\n", encoding);
-        return dsERR_OPERATION_NOT_SUPPORTED;
-    }
-
-    /* Prefer snd_ctl path for vc4hdmi0 and fall back to mixer where available. */
-    if (dsIec958CtlWriteSwitch(s_card, iec958_enabled) != 0) {
-        if ((initAlsa("IEC958", s_card, &mixer, &iec958_elem) == 0) && (iec958_elem != NULL) &&
-                snd_mixer_selem_has_playback_switch(iec958_elem)) {
-            if (snd_mixer_selem_set_playback_switch_all(iec958_elem, iec958_enabled) != 0) {
-                hal_err("Failed to set IEC958 playback switch for encoding(%d).\n", encoding);
-                dsCloseMixerHandle(&mixer);
-                return dsERR_GENERAL;
-            }
-        } else {
-            hal_err("IEC958 control not available; cannot set encoding(%d).\n", encoding);
-            dsCloseMixerHandle(&mixer);
-            return dsERR_OPERATION_NOT_SUPPORTED;
-        }
+    dsMixerSessionLock();
+    ret = dsApplyEncodingLocked(encoding);
+    dsMixerSessionUnlock();
+    if (ret != dsERR_NONE) {
+        return ret;
     }
-
-    _encoding = encoding;
-    dsCloseMixerHandle(&mixer);
 #endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
 
     if (_halaudioformatCB != NULL && oldFormat != newFormat) {
@@ -1433,33 +2731,10 @@ dsError_t dsSetStereoMode(intptr_t handle, dsAudioStereoMode_t mode)
     return dsERR_OPERATION_NOT_SUPPORTED;
 #else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
     dsAudioEncoding_t targetEncoding;
-    dsError_t ret = dsERR_NONE;
+    dsError_t ret = dsEncodingFromStereoMode(mode, _encoding, &targetEncoding);
 
-    /* Map stereo mode to encoding for ALSA control */
-    switch (mode) {
-        case dsAUDIO_STEREO_STEREO:
-            targetEncoding = dsAUDIO_ENC_PCM;
-            break;
-        case dsAUDIO_STEREO_DD:
-            targetEncoding = dsAUDIO_ENC_AC3;
-            break;
-        case dsAUDIO_STEREO_DDPLUS:
-            targetEncoding = dsAUDIO_ENC_EAC3;
-            break;
-        case dsAUDIO_STEREO_PASSTHRU:
-            /* Passthrough: preserve current encoding if AC3/EAC3, else default to AC3 */
-            if (_encoding == dsAUDIO_ENC_AC3 || _encoding == dsAUDIO_ENC_EAC3) {
-                targetEncoding = _encoding;
-            } else {
-                targetEncoding = dsAUDIO_ENC_AC3;
-            }
-            break;
-        case dsAUDIO_STEREO_MONO: /* No standard ALSA "set mono" API */
-        case dsAUDIO_STEREO_SURROUND:
-        case dsAUDIO_STEREO_UNKNOWN:
-        default:
-            hal_err("Unsupported stereo mode(%d) for ALSA experimental path.\n", mode);
-            return dsERR_OPERATION_NOT_SUPPORTED;
+    if (ret != dsERR_NONE) {
+        return ret;
     }
 
     ret = dsSetAudioEncoding(handle, targetEncoding);
@@ -1548,71 +2823,37 @@ dsError_t dsSetAudioGain(intptr_t handle, float gain)
     hal_dbg("Audio gain control is not supported on source devices.\n");
     return dsERR_OPERATION_NOT_SUPPORTED;
 #else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
-    const char *s_card = dsGetPreferredAlsaCard();
     bool usingSoftvol = false;
     bool enabled = false;
-    snd_mixer_t *mixer = NULL;
-    snd_mixer_elem_t *mixer_elem;
+    snd_mixer_elem_t *mixer_elem = NULL;
 
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0 || mixer_elem == NULL) {
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
+    if (mixer_elem == NULL) {
         hal_err("Failed to initialize ALSA!\n");
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionUnlock();
         return dsERR_GENERAL;
     }
 
-    if (dsIsAudioMute(handle, &enabled) != dsERR_NONE) {
+    if (dsMixerGetMuteLocked(mixer_elem, usingSoftvol, &enabled) != dsERR_NONE) {
         hal_err("dsIsAudioMute returned error.\n");
     }
     hal_dbg("Mute status before changing gain: %d\n", enabled);
 
-    long vol_min, vol_max;
-    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
-        long min = 0, max = 0;
-        long vol;
-        if (gain < 0.0f) {
-            gain = 0.0f;
-        }
-        if (gain > 100.0f) {
-            gain = 100.0f;
-        }
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-        vol = (long)(((gain / 100.0f) * (max - min)) + min);
-        snd_mixer_selem_set_playback_volume_all(mixer_elem, vol);
-        if (enabled) {
-            hal_dbg("Muting after changing gain to reset to previous state.\n");
-            dsError_t muteRet = dsSetAudioMute(handle, enabled);
-            dsCloseMixerHandle(&mixer);
-            return muteRet;
-        }
-        dsCloseMixerHandle(&mixer);
-        return dsERR_NONE;
-    }
-
-    gain /= 100.0f;
-
-    snd_mixer_selem_get_playback_dB_range(mixer_elem, &vol_min, &vol_max);
-    if (vol_max - vol_min <= MAX_LINEAR_DB_SCALE * 100) {
-        long floatval = lrint(gain * (vol_max - vol_min)) + vol_min;
-        hal_dbg("Setting gain in dB: %.2f \n", floatval / 100.0);
-        snd_mixer_selem_set_playback_dB_all(mixer_elem, floatval, 0);
-    } else {
-        if (vol_min != SND_CTL_TLV_DB_GAIN_MUTE) {
-            double min_norm = pow(10, (vol_min - vol_max) / 6000.0);
-            gain = gain * (1 - min_norm) + min_norm;
-        }
-        long floatval = lrint(6000.0 * log10(gain)) + vol_max;
-        hal_dbg("Setting gain in dB: %.2f \n", floatval / 100.0);
-        snd_mixer_selem_set_playback_dB_all(mixer_elem, floatval, 0);
+    if (dsMixerWriteGainLocked(mixer_elem, usingSoftvol, gain) != dsERR_NONE) {
+        dsMixerSessionUnlock();
+        return dsERR_GENERAL;
     }
+    dsAudioDuckUpdateTargetLocked();
 
     if (enabled) {
         hal_dbg("Muting after changing gain to reset to previous state.\n");
-        dsError_t muteRet = dsSetAudioMute(handle, enabled);
-        dsCloseMixerHandle(&mixer);
+        dsError_t muteRet = dsMixerSetMuteLocked(mixer_elem, usingSoftvol, enabled);
+        dsMixerSessionWriteUnlock();
         return muteRet;
     }
 
-    dsCloseMixerHandle(&mixer);
+    dsMixerSessionWriteUnlock();
     return dsERR_NONE;
 #endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
 }
@@ -1629,40 +2870,37 @@ dsError_t dsSetAudioDB(intptr_t handle, float db)
         return dsERR_INVALID_PARAM;
     }
 
-    const char *s_card = dsGetPreferredAlsaCard();
     bool usingSoftvol = false;
-    snd_mixer_t *mixer = NULL;
     snd_mixer_elem_t *mixer_elem = NULL;
 
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0 || mixer_elem == NULL) {
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
+    if (mixer_elem == NULL) {
         hal_err("Failed to initialize ALSA!\n");
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionUnlock();
         return dsERR_GENERAL;
     }
 
     db = (db < dBmin) ? dBmin : (db > dBmax) ? dBmax : db;
     hal_info("Setting dB to %.2f\n", db);
 
-    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem)) {
-        long min = 0, max = 0;
-        long vol;
-        snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-        vol = (long)(((db / 100.0f) * (max - min)) + min);
+    if (usingSoftvol && snd_mixer_selem_has_playback_volume(mixer_elem) && gMixerSession.gain.valid) {
+        long vol = dsGainTableValue(gMixerSession.gain.gainToRaw, db);
         if (snd_mixer_selem_set_playback_volume_all(mixer_elem, vol) == 0) {
-            dsCloseMixerHandle(&mixer);
+            dsMixerSessionWriteUnlock();
             return dsERR_NONE;
         }
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionWriteUnlock();
         return dsERR_GENERAL;
     }
 
     if (snd_mixer_selem_set_playback_dB_all(mixer_elem, (long) db * 100, 0) == 0) {
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionWriteUnlock();
         return dsERR_NONE;
     }
 
     hal_err("snd_mixer_selem_set_playback_dB_all failed.\n");
-    dsCloseMixerHandle(&mixer);
+    dsMixerSessionWriteUnlock();
     return dsERR_GENERAL;
 }
 
@@ -1705,33 +2943,236 @@ dsError_t dsSetAudioLevel(intptr_t handle, float level)
     hal_dbg("Audio level control is not supported on source devices.\n");
     return dsERR_OPERATION_NOT_SUPPORTED;
 #else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
-    const char *s_card = dsGetPreferredAlsaCard();
     bool usingSoftvol = false;
-    snd_mixer_t *mixer = NULL;
     snd_mixer_elem_t *mixer_elem = NULL;
 
-    if (dsInitAudioMixerElem(s_card, &mixer, &mixer_elem, &usingSoftvol) != 0 || mixer_elem == NULL) {
+    dsMixerSessionLock();
+    mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
+    if (mixer_elem == NULL) {
         hal_warn("No simple mixer control on HDMI card; level control unsupported.\n");
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionUnlock();
         return dsERR_OPERATION_NOT_SUPPORTED;
     }
 
-    long min, max;
-    snd_mixer_selem_get_playback_volume_range(mixer_elem, &min, &max);
-    if (!usingSoftvol && level != 0) {
-        min /= 2;
+    const dsAudioGainTables_t *tables = &gMixerSession.gain;
+    if (!tables->valid) {
+        hal_warn("No playback volume range on HDMI card; level control unsupported.\n");
+        dsMixerSessionUnlock();
+        return dsERR_OPERATION_NOT_SUPPORTED;
     }
 
-    long vol_value = (long)(((level / 100.0) * (max - min)) + min);
+    long vol_value = (level == 0) ? tables->volMin : dsGainTableValue(tables->levelToRaw, level);
     hal_info("Setting volume to %ld\n", vol_value);
     if (snd_mixer_selem_set_playback_volume_all(mixer_elem, vol_value) != 0) {
         hal_err("snd_mixer_selem_set_playback_volume_all failed.\n");
-        dsCloseMixerHandle(&mixer);
+        dsMixerSessionWriteUnlock();
         return dsERR_GENERAL;
     }
 
-    dsCloseMixerHandle(&mixer);
+    dsMixerSessionWriteUnlock();
+    return dsERR_NONE;
+#endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
+}
+
+/**
+ * @brief Starts a new audio settings transaction on an audio port.
+ *
+ * @see dsAudioTransactionCommit()
+ */
+dsError_t dsAudioTransactionBegin(intptr_t handle, dsAudioTransaction_t *txn)
+{
+    hal_info("invoked.\n");
+    if (!_bIsAudioInitialized) {
+        return dsERR_NOT_INITIALIZED;
+    }
+    if (txn == NULL || !dsAudioIsValidHandle(handle)) {
+        hal_err("Invalid parameters; handle(%p) or txn(%p).\n", handle, txn);
+        return dsERR_INVALID_PARAM;
+    }
+    memset(txn, 0, sizeof(*txn));
+    txn->handle = handle;
+    return dsERR_NONE;
+}
+
+dsError_t dsAudioTransactionSetMute(dsAudioTransaction_t *txn, bool mute)
+{
+    if (txn == NULL || !dsAudioIsValidHandle(txn->handle)) {
+        hal_err("Invalid parameter; txn(%p).\n", txn);
+        return dsERR_INVALID_PARAM;
+    }
+    txn->mute = mute;
+    txn->staged |= dsAUDIO_TXN_MUTE;
+    return dsERR_NONE;
+}
+
+dsError_t dsAudioTransactionSetGain(dsAudioTransaction_t *txn, float gain)
+{
+    if (txn == NULL || !dsAudioIsValidHandle(txn->handle)) {
+        hal_err("Invalid parameter; txn(%p).\n", txn);
+        return dsERR_INVALID_PARAM;
+    }
+    txn->gain = gain;
+    txn->staged |= dsAUDIO_TXN_GAIN;
+    return dsERR_NONE;
+}
+
+dsError_t dsAudioTransactionSetEncoding(dsAudioTransaction_t *txn, dsAudioEncoding_t encoding)
+{
+    if (txn == NULL || !dsAudioIsValidHandle(txn->handle)) {
+        hal_err("Invalid parameter; txn(%p).\n", txn);
+        return dsERR_INVALID_PARAM;
+    }
+    txn->encoding = encoding;
+    txn->staged |= dsAUDIO_TXN_ENCODING;
+    return dsERR_NONE;
+}
+
+dsError_t dsAudioTransactionSetStereoMode(dsAudioTransaction_t *txn, dsAudioStereoMode_t mode)
+{
+    if (txn == NULL || !dsAudioIsValidHandle(txn->handle) || mode >= dsAUDIO_STEREO_MAX || mode <= dsAUDIO_STEREO_UNKNOWN) {
+        hal_err("Invalid parameters; txn(%p) or mode(%d).\n", txn, mode);
+        return dsERR_INVALID_PARAM;
+    }
+    txn->stereoMode = mode;
+    txn->staged |= dsAUDIO_TXN_STEREO_MODE;
+    return dsERR_NONE;
+}
+
+dsError_t dsAudioTransactionAbort(dsAudioTransaction_t *txn)
+{
+    if (txn == NULL) {
+        return dsERR_INVALID_PARAM;
+    }
+    txn->staged = 0;
     return dsERR_NONE;
+}
+
+/**
+ * @brief Applies all settings staged in an audio transaction.
+ *
+ * Writes go through the mixer session under one lock: mute-on first, then gain, then
+ * the IEC958 encoding, then mute-off, skipping writes that match the current state.
+ * The audio format callback fires at most once, after the lock is released.
+ *
+ * @param[in] txn  - Transaction to commit; cleared on return
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Success
+ * @retval dsERR_NOT_INITIALIZED          -  Module is not initialised
+ * @retval dsERR_INVALID_PARAM            -  Transaction is invalid or has conflicting settings
+ * @retval dsERR_OPERATION_NOT_SUPPORTED  -  A staged setting is not supported
+ * @retval dsERR_GENERAL                  -  Underlying undefined platform error
+ *
+ * @see dsAudioTransactionBegin()
+ */
+dsError_t dsAudioTransactionCommit(dsAudioTransaction_t *txn)
+{
+    hal_info("invoked.\n");
+    if (!_bIsAudioInitialized) {
+        return dsERR_NOT_INITIALIZED;
+    }
+    if (txn == NULL || !dsAudioIsValidHandle(txn->handle)) {
+        hal_err("Invalid parameter; txn(%p).\n", txn);
+        return dsERR_INVALID_PARAM;
+    }
+
+    dsAudioTransaction_t staged = *txn;
+    txn->staged = 0;
+    if (staged.staged == 0) {
+        return dsERR_NONE;
+    }
+#ifndef DSHAL_ENABLE_ALSA_EXPERIMENTAL
+    return dsERR_OPERATION_NOT_SUPPORTED;
+#else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
+    dsError_t ret = dsERR_NONE;
+    dsAudioFormat_t oldFormat, newFormat;
+    dsAudioEncoding_t targetEncoding = dsAUDIO_ENC_PCM;
+    bool haveEncoding = false;
+    snd_mixer_elem_t *mixer_elem = NULL;
+    bool usingSoftvol = false;
+    bool hasSwitch = false;
+    bool muted = false;
+    bool targetMute;
+    int iec958_enabled;
+
+    dsMixerSessionLock();
+    oldFormat = dsFormatFromEncoding(_encoding);
+
+    /* Resolve and validate everything before the first write. */
+    if (staged.staged & dsAUDIO_TXN_ENCODING) {
+        targetEncoding = staged.encoding;
+        haveEncoding = true;
+    }
+    if (staged.staged & dsAUDIO_TXN_STEREO_MODE) {
+        dsAudioEncoding_t modeEncoding;
+        ret = dsEncodingFromStereoMode(staged.stereoMode, haveEncoding ? targetEncoding : _encoding, &modeEncoding);
+        if (ret != dsERR_NONE) {
+            dsMixerSessionUnlock();
+            return ret;
+        }
+        if (haveEncoding && modeEncoding != targetEncoding) {
+            hal_err("Stereo mode(%d) conflicts with encoding(%d).\n", staged.stereoMode, targetEncoding);
+            dsMixerSessionUnlock();
+            return dsERR_INVALID_PARAM;
+        }
+        targetEncoding = modeEncoding;
+        haveEncoding = true;
+    }
+    if (haveEncoding && !dsEncodingToIec958Switch(targetEncoding, &iec958_enabled)) {
+        hal_err("Unsupported encoding(%d) for ALSA experimental path.\n", targetEncoding);
+        dsMixerSessionUnlock();
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    if (staged.staged & (dsAUDIO_TXN_MUTE | dsAUDIO_TXN_GAIN)) {
+        mixer_elem = dsMixerSessionElemLocked(&usingSoftvol);
+        if (mixer_elem == NULL) {
+            hal_warn("ALSA mixer not available on HDMI card; mute/gain control unsupported.\n");
+            dsMixerSessionUnlock();
+            return dsERR_OPERATION_NOT_SUPPORTED;
+        }
+        hasSwitch = snd_mixer_selem_has_playback_switch(mixer_elem);
+        if (dsMixerGetMuteLocked(mixer_elem, usingSoftvol, &muted) != dsERR_NONE) {
+            muted = false;
+        }
+    }
+    targetMute = (staged.staged & dsAUDIO_TXN_MUTE) ? staged.mute : muted;
+
+    /* Mute before gain/format changes so they are not audible. */
+    if (mixer_elem != NULL && targetMute && !muted) {
+        ret = dsMixerSetMuteLocked(mixer_elem, usingSoftvol, true);
+    }
+    if (ret == dsERR_NONE && (staged.staged & dsAUDIO_TXN_GAIN)) {
+        if (!hasSwitch && targetMute) {
+            /* Volume-floor mute: park the gain for the unmute path instead of writing it. */
+            _softvolSavedVolume = dsGainTableValue(gMixerSession.gain.gainToRaw, staged.gain);
+        } else {
+            ret = dsMixerWriteGainLocked(mixer_elem, usingSoftvol, staged.gain);
+            dsAudioDuckUpdateTargetLocked();
+        }
+    }
+    if (ret == dsERR_NONE && haveEncoding && targetEncoding != _encoding) {
+        ret = dsApplyEncodingLocked(targetEncoding);
+    }
+    if (ret == dsERR_NONE && (staged.staged & dsAUDIO_TXN_STEREO_MODE)) {
+        _stereoModeHDMI = staged.stereoMode;
+    }
+    /* Without a switch, writing the gain has already lifted the volume floor. */
+    if (ret == dsERR_NONE && mixer_elem != NULL && !targetMute && muted &&
+            (hasSwitch || !(staged.staged & dsAUDIO_TXN_GAIN))) {
+        ret = dsMixerSetMuteLocked(mixer_elem, usingSoftvol, false);
+    }
+    newFormat = dsFormatFromEncoding(_encoding);
+
+    if (mixer_elem != NULL) {
+        dsMixerSessionWriteUnlock();
+    } else {
+        dsMixerSessionUnlock();
+    }
+
+    if (_halaudioformatCB != NULL && oldFormat != newFormat) {
+        _halaudioformatCB(newFormat);
+    }
+    return ret;
 #endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
 }
 
@@ -1773,11 +3214,21 @@ dsError_t dsAudioPortTerm()
     {
         return dsERR_NOT_INITIALIZED;
     }
-    /* HDMI audio status callbacks removed: now managed by display module */
+    /* Waits for an in-flight hotplug callback, so none fires after this point. */
+    if (_hdmiAudioEventToken != 0) {
+        (void)dsDisplayEventUnsubscribe(_hdmiAudioEventToken);
+        _hdmiAudioEventToken = 0;
+    }
     pthread_mutex_lock(&gHdmiAudioCbMutex);
     _halhdmiaudioCB = NULL;
     pthread_mutex_unlock(&gHdmiAudioCbMutex);
+    dsAudioMonitorStop();
+    dsAudioDuckStop();
     _halaudioformatCB = NULL;
+    dsMixerSessionLock();
+    dsMixerSessionCloseLocked();
+    dsMixerSessionUnlock();
+    dsIec958CtlInvalidate();
     _bIsAudioInitialized = false;
     return ret;
 }
@@ -2817,8 +4268,13 @@ dsError_t dsGetAudioDelay(intptr_t handle, uint32_t *audioDelayMs)
         hal_err("Invalid parameters; audioDelayMs(%p) or handle(%p).\n", audioDelayMs, handle);
         return dsERR_INVALID_PARAM;
     }
-    /* RPi vc4-hdmi driver does not expose a configurable audio delay via ALSA or sysfs. */
-    return dsERR_OPERATION_NOT_SUPPORTED;
+    pthread_mutex_lock(&gAudioDelayMutex);
+    if (dsAudioDelayCtlGetLocked(DSAUDIO_DELAY_CTL_NAME, &_audioDelayMs) != 0) {
+        hal_dbg("Delay ctl not readable; returning cached value.\n");
+    }
+    *audioDelayMs = _audioDelayMs;
+    pthread_mutex_unlock(&gAudioDelayMutex);
+    return dsERR_NONE;
 }
 
 /**
@@ -2850,11 +4306,20 @@ dsError_t dsSetAudioDelay(intptr_t handle, const uint32_t audioDelayMs)
     if (false == _bIsAudioInitialized) {
         return dsERR_NOT_INITIALIZED;
     }
-    if (!dsAudioIsValidHandle(handle) || audioDelayMs > 200) {
+    if (!dsAudioIsValidHandle(handle) || audioDelayMs > DSAUDIO_DELAY_MAX_MS) {
         hal_err("Invalid parameters; handle(%p) or audioDelayMs(%d).\n", handle, audioDelayMs);
         return dsERR_INVALID_PARAM;
     }
-    return dsERR_OPERATION_NOT_SUPPORTED;
+    dsError_t ret = dsERR_NONE;
+
+    pthread_mutex_lock(&gAudioDelayMutex);
+    if (dsAudioDelayCtlSetLocked(DSAUDIO_DELAY_CTL_NAME, audioDelayMs) == 0) {
+        _audioDelayMs = audioDelayMs;
+    } else {
+        ret = dsERR_GENERAL;
+    }
+    pthread_mutex_unlock(&gAudioDelayMutex);
+    return ret;
 }
 
 dsError_t dsGetAudioDelayOffset(intptr_t handle, uint32_t *audioDelayOffsetMs)
@@ -2867,8 +4332,13 @@ dsError_t dsGetAudioDelayOffset(intptr_t handle, uint32_t *audioDelayOffsetMs)
         hal_err("Invalid parameters; audioDelayOffsetMs(%p) or handle(%p).\n", audioDelayOffsetMs, handle);
         return dsERR_INVALID_PARAM;
     }
-    /* RPi vc4-hdmi driver does not expose a configurable audio delay offset via ALSA or sysfs. */
-    return dsERR_OPERATION_NOT_SUPPORTED;
+    pthread_mutex_lock(&gAudioDelayMutex);
+    if (dsAudioDelayCtlGetLocked(DSAUDIO_DELAY_OFFSET_CTL_NAME, &_audioDelayOffsetMs) != 0) {
+        hal_dbg("Delay offset ctl not readable; returning cached value.\n");
+    }
+    *audioDelayOffsetMs = _audioDelayOffsetMs;
+    pthread_mutex_unlock(&gAudioDelayMutex);
+    return dsERR_NONE;
 }
 
 dsError_t dsSetAudioDelayOffset(intptr_t handle, const uint32_t audioDelayOffsetMs)
@@ -2877,11 +4347,20 @@ dsError_t dsSetAudioDelayOffset(intptr_t handle, const uint32_t audioDelayOffset
     if (false == _bIsAudioInitialized) {
         return dsERR_NOT_INITIALIZED;
     }
-    if (!dsAudioIsValidHandle(handle)) {
+    if (!dsAudioIsValidHandle(handle) || audioDelayOffsetMs > DSAUDIO_DELAY_MAX_MS) {
         hal_err("Invalid parameters; handle(%p) with audioDelayOffsetMs %d.\n", handle, audioDelayOffsetMs);
         return dsERR_INVALID_PARAM;
     }
-    return dsERR_OPERATION_NOT_SUPPORTED;
+    dsError_t ret = dsERR_NONE;
+
+    pthread_mutex_lock(&gAudioDelayMutex);
+    if (dsAudioDelayCtlSetLocked(DSAUDIO_DELAY_OFFSET_CTL_NAME, audioDelayOffsetMs) == 0) {
+        _audioDelayOffsetMs = audioDelayOffsetMs;
+    } else {
+        ret = dsERR_GENERAL;
+    }
+    pthread_mutex_unlock(&gAudioDelayMutex);
+    return ret;
 }
 
 /**
@@ -3110,7 +4589,26 @@ dsError_t dsSetAudioDucking(intptr_t handle, dsAudioDuckingAction_t action, dsAu
         hal_err("Invalid parameters; handle(%p) or level(%d) or action(%d) or type(%d).\n", handle, level, action, type);
         return dsERR_INVALID_PARAM;
     }
+#ifndef DSHAL_ENABLE_ALSA_EXPERIMENTAL
     return dsERR_OPERATION_NOT_SUPPORTED;
+#else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
+    dsMixerSessionLock();
+    if (!gAudioDuck.threadRunning || dsMixerSessionFindElemLocked(ALSA_DUCK_ELEMENT_NAME) == NULL) {
+        hal_warn("%s control not available; ducking unsupported.\n", ALSA_DUCK_ELEMENT_NAME);
+        dsMixerSessionUnlock();
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    pthread_mutex_lock(&gAudioDuck.mutex);
+    gAudioDuck.active = (action == dsAUDIO_DUCKINGACTION_START);
+    gAudioDuck.type = type;
+    gAudioDuck.level = level;
+    pthread_mutex_unlock(&gAudioDuck.mutex);
+    dsAudioDuckUpdateTargetLocked();
+    dsMixerSessionUnlock();
+    hal_info("Ducking %s, type %d, level %d\n", (action == dsAUDIO_DUCKINGACTION_START) ? "started" : "stopped",
+            type, level);
+    return dsERR_NONE;
+#endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
 }
 
 /**
@@ -3229,6 +4727,12 @@ dsError_t dsAudioOutRegisterConnectCB(dsAudioOutPortConnectCB_t CBFunc)
     }
     _halhdmiaudioCB = CBFunc;
     pthread_mutex_unlock(&gHdmiAudioCbMutex);
+    if (_hdmiAudioEventToken == 0 &&
+            dsDisplayEventSubscribe(hdmiAudioDisplayEvent, NULL, &_hdmiAudioEventToken) != dsERR_NONE) {
+        hal_err("Failed to subscribe to HDMI display events.\n");
+        _hdmiAudioEventToken = 0;
+        return dsERR_GENERAL;
+    }
     return dsERR_NONE;
 }
 
@@ -3756,6 +5260,39 @@ dsError_t dsSetAudioMixerLevels(intptr_t handle, dsAudioInput_t aInput, int volu
         hal_err("Invalid parameters; handle(%p) or volume(%d) or aInput(%d).\n", handle, volume, aInput);
         return dsERR_INVALID_PARAM;
     }
-    /* RPi does not support audio mixer level controls, hence this operation is not supported. */
+#ifndef DSHAL_ENABLE_ALSA_EXPERIMENTAL
     return dsERR_OPERATION_NOT_SUPPORTED;
+#else /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
+    /*
+     * The IEC958 sink is exclusive and has no mixing stage, so system sounds can never
+     * play alongside primary content; only the primary level has a stage to set.
+     */
+    static const char *const kInputElements[dsAUDIO_INPUT_MAX] = {
+        [dsAUDIO_INPUT_PRIMARY] = ALSA_PRIMARY_ELEMENT_NAME,
+    };
+    snd_mixer_elem_t *input_elem = NULL;
+    long min = 0, max = 0;
+
+    if (kInputElements[aInput] == NULL) {
+        hal_warn("No mixer stage for input(%d).\n", aInput);
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+
+    dsMixerSessionLock();
+    input_elem = dsMixerSessionFindElemLocked(kInputElements[aInput]);
+    if (input_elem == NULL || !snd_mixer_selem_has_playback_volume(input_elem)) {
+        hal_warn("%s control not available; mixer level unsupported.\n", kInputElements[aInput]);
+        dsMixerSessionUnlock();
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    snd_mixer_selem_get_playback_volume_range(input_elem, &min, &max);
+    if (snd_mixer_selem_set_playback_volume_all(input_elem, min + ((max - min) * volume) / 100) != 0) {
+        hal_err("Failed to set %s to %d.\n", kInputElements[aInput], volume);
+        dsMixerSessionUnlock();
+        return dsERR_GENERAL;
+    }
+    dsMixerSessionUnlock();
+    hal_info("Mixer level for input(%d) set to %d\n", aInput, volume);
+    return dsERR_NONE;
+#endif /* DSHAL_ENABLE_ALSA_EXPERIMENTAL */
 }
@@ -0,0 +1,33 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DSAUDIODELAYCTL_H
+#define __DSAUDIODELAYCTL_H
+
+/*
+ * Integer ctl elements, in milliseconds, that carry the audio delay from the HAL
+ * (dsSetAudioDelay / dsSetAudioDelayOffset) to the dsdelay ALSA plugin. The HAL
+ * creates them on the card; the plugin only reads them.
+ */
+#define DSAUDIO_DELAY_CTL_NAME "DS Audio Delay"
+#define DSAUDIO_DELAY_OFFSET_CTL_NAME "DS Audio Delay Offset"
+/* Range of each element; the plugin delays by up to twice this. */
+#define DSAUDIO_DELAY_MAX_MS 200
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DSAUDIOTRANSACTION_H
+#define __DSAUDIOTRANSACTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsAudio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define dsAUDIO_TXN_MUTE        (1u << 0)
+#define dsAUDIO_TXN_GAIN        (1u << 1)
+#define dsAUDIO_TXN_ENCODING    (1u << 2)
+#define dsAUDIO_TXN_STEREO_MODE (1u << 3)
+
+/**
+ * @brief Staged audio port settings, owned by the caller.
+ *
+ * Fill with dsAudioTransactionBegin() and the dsAudioTransactionSet*() calls;
+ * nothing touches ALSA until dsAudioTransactionCommit().
+ */
+typedef struct _dsAudioTransaction_t {
+    intptr_t handle;                    /* Audio port handle from dsGetAudioPort() */
+    unsigned int staged;                /* dsAUDIO_TXN_* bits */
+    bool mute;
+    float gain;                         /* 0-100, as dsSetAudioGain() */
+    dsAudioEncoding_t encoding;
+    dsAudioStereoMode_t stereoMode;
+} dsAudioTransaction_t;
+
+/**
+ * @brief Starts a new audio settings transaction on an audio port.
+ *
+ * @param[in]  handle  - Handle for the output audio port
+ * @param[out] txn     - Transaction to initialise
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Success
+ * @retval dsERR_NOT_INITIALIZED          -  Module is not initialised
+ * @retval dsERR_INVALID_PARAM            -  Parameter passed to this function is invalid
+ *
+ * @pre  dsAudioPortInit() and dsGetAudioPort() should be called before calling this API.
+ */
+dsError_t dsAudioTransactionBegin(intptr_t handle, dsAudioTransaction_t *txn);
+
+/**
+ * @brief Stages a mute change. A later call for the same setting replaces the earlier one.
+ */
+dsError_t dsAudioTransactionSetMute(dsAudioTransaction_t *txn, bool mute);
+
+/**
+ * @brief Stages a gain change (0-100).
+ */
+dsError_t dsAudioTransactionSetGain(dsAudioTransaction_t *txn, float gain);
+
+/**
+ * @brief Stages an encoding change.
+ */
+dsError_t dsAudioTransactionSetEncoding(dsAudioTransaction_t *txn, dsAudioEncoding_t encoding);
+
+/**
+ * @brief Stages a stereo mode change.
+ *
+ * The stereo mode is applied through the encoding, so it must agree with any encoding
+ * staged in the same transaction.
+ */
+dsError_t dsAudioTransactionSetStereoMode(dsAudioTransaction_t *txn, dsAudioStereoMode_t mode);
+
+/**
+ * @brief Applies all staged settings.
+ *
+ * The settings are written on the shared mixer session under a single lock, in the
+ * order mute-on, gain, encoding, mute-off, and writes that would not change the
+ * hardware state are skipped. The audio format callback fires at most once, after
+ * the session lock is released. On return the transaction is cleared.
+ *
+ * @param[in] txn  - Transaction to commit
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Success
+ * @retval dsERR_NOT_INITIALIZED          -  Module is not initialised
+ * @retval dsERR_INVALID_PARAM            -  Transaction is invalid or has conflicting settings
+ * @retval dsERR_OPERATION_NOT_SUPPORTED  -  A staged setting is not supported
+ * @retval dsERR_GENERAL                  -  Underlying undefined platform error
+ */
+dsError_t dsAudioTransactionCommit(dsAudioTransaction_t *txn);
+
+/**
+ * @brief Drops all staged settings without touching ALSA.
+ */
+dsError_t dsAudioTransactionAbort(dsAudioTransaction_t *txn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
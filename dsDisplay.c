@@ -22,12 +22,12 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
-#include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <poll.h>
+#include <sys/eventfd.h>
 #include <libudev.h>
 
 #include "dsTypes.h"
@@ -37,169 +37,570 @@
 #include "dsError.h"
 #include "dshalLogger.h"
 #include "dshalEdidParser.h"
-
-extern dsVideoPortResolution_t kResolutionsSettings[];
-extern size_t kNumResolutionsSettings;
-
 #include "dshalUtils.h"
+#include "dsDisplayHotplugStats.h"
 #include "halif-versions.h"
 
 dsDisplayEventCallback_t _halcallback = NULL;
-extern dsAudioOutPortConnectCB_t _halhdmiaudioCB;
 dsVideoPortResolution_t *HdmiSupportedResolution = NULL;
 static unsigned int numSupportedResn = 0;
 static bool _bDisplayInited = false;
+static bool _bDrmContextHeld = false;
+/* Subscription that forwards display events to the dsRegisterDisplayEventCallback() client. */
+static uint32_t _displayClientToken = 0;
+
+/* Forward declaration used by watcher helpers defined before full struct body. */
+typedef struct _VDISPHandle_t VDISPHandle_t;
 
-extern pthread_mutex_t gHdmiAudioCbMutex;
+/* Query APIs read the watcher's snapshot; before the first one they read DRM directly. */
+static bool drm_get_hdmi_connector_state(bool *connected, bool *enabled)
+{
+    return dsGetHdmiConnectorStateCached(connected, enabled);
+}
+
+/* HDMI connection watcher thread state (udev + libdrm) */
+static pthread_t gHdmiWatcherThread = (pthread_t)(-1);
+static atomic_bool gHdmiWatcherRunning = ATOMIC_VAR_INIT(false);
+static bool gLastHdmiConnected = false;
+static pthread_mutex_t gHdmiWatcherMutex = PTHREAD_MUTEX_INITIALIZER;
+static struct udev *gUdevCtx = NULL;
+static struct udev_monitor *gUdevMonitor = NULL;
+static int gUdevFd = -1;
+static int gHdmiWatcherWakeFd = -1;
+
+/* Adds one to an eventfd counter. EAGAIN means it is saturated, i.e. already signalled. */
+static bool hdmi_eventfd_signal(int fd)
+{
+    uint64_t one = 1;
+
+    while (write(fd, &one, sizeof(one)) < 0) {
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN) {
+            return true;
+        }
+        hal_err("HDMI eventfd %d write failed: %s\n", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
 
-static dsAudioOutPortConnectCB_t get_hdmi_audio_cb(void)
+/* Clears a non-blocking eventfd counter. */
+static void hdmi_eventfd_drain(int fd)
 {
-    dsAudioOutPortConnectCB_t cb;
-    pthread_mutex_lock(&gHdmiAudioCbMutex);
-    cb = _halhdmiaudioCB;
-    pthread_mutex_unlock(&gHdmiAudioCbMutex);
-    return cb;
+    uint64_t value;
+
+    while (read(fd, &value, sizeof(value)) < 0) {
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN) {
+            hal_err("HDMI eventfd %d read failed: %s\n", fd, strerror(errno));
+        }
+        break;
+    }
 }
 
-static void notify_audio_hotplug(bool connected)
+/*
+ * The watcher only re-scans DRM on udev HOTPLUG=1 change events. An optional safety
+ * poll (DSHAL_HDMI_SAFETY_POLL_MS, milliseconds) re-scans on idle timeouts; 0 disables it.
+ */
+#define HDMI_WATCHER_SAFETY_POLL_MS_DEFAULT 0
+
+static int hdmi_watcher_safety_poll_ms(void)
 {
-    dsAudioOutPortConnectCB_t cb = get_hdmi_audio_cb();
-    if (cb != NULL) {
-        cb(dsAUDIOPORT_TYPE_HDMI, 0, connected);
+    const char *value = getenv("DSHAL_HDMI_SAFETY_POLL_MS");
+    char *end = NULL;
+    long ms;
+
+    if (value == NULL || value[0] == '\0') {
+        return HDMI_WATCHER_SAFETY_POLL_MS_DEFAULT;
+    }
+    ms = strtol(value, &end, 10);
+    if (*end != '\0' || ms < 0 || ms > INT_MAX) {
+        hal_warn("Ignoring invalid DSHAL_HDMI_SAFETY_POLL_MS=%s\n", value);
+        return HDMI_WATCHER_SAFETY_POLL_MS_DEFAULT;
     }
+    return (int)ms;
 }
 
-/* Forward declaration used by watcher helpers defined before full struct body. */
-typedef struct _VDISPHandle_t VDISPHandle_t;
+/* True for DRM change events that carry HOTPLUG=1. */
+static bool hdmi_watcher_is_hotplug_event(struct udev_device *dev)
+{
+    const char *subsystem = udev_device_get_subsystem(dev);
+    const char *action = udev_device_get_action(dev);
+    const char *hotplug = udev_device_get_property_value(dev, "HOTPLUG");
+
+    hal_dbg("udev DRM event: action=%s sysname=%s hotplug=%s\n",
+            action ? action : "unknown",
+            udev_device_get_sysname(dev) ? udev_device_get_sysname(dev) : "unknown",
+            hotplug ? hotplug : "-");
+
+    return (subsystem != NULL) && (strcmp(subsystem, "drm") == 0) &&
+           (action != NULL) && (strcmp(action, "change") == 0) &&
+           (hotplug != NULL) && (strcmp(hotplug, "1") == 0);
+}
 
-static void resolve_drm_card_name(char *cardName, size_t len)
+/* Reads the CONNECTOR property of a hotplug event; false if absent, so the caller re-scans everything. */
+static bool hdmi_watcher_event_connector(struct udev_device *dev, uint32_t *connectorId)
 {
-    const char *cardPath = getenv("WESTEROS_DRM_CARD");
-    if (cardPath == NULL || cardPath[0] == '\0') {
-        cardPath = DRI_CARD;
+    const char *value = udev_device_get_property_value(dev, "CONNECTOR");
+    char *end = NULL;
+    unsigned long id;
+
+    if (value == NULL || value[0] == '\0') {
+        return false;
     }
+    id = strtoul(value, &end, 10);
+    if (*end != '\0' || id == 0 || id > UINT32_MAX) {
+        return false;
+    }
+    *connectorId = (uint32_t)id;
+    return true;
+}
 
-    const char *slash = strrchr(cardPath, '/');
-    const char *base = (slash != NULL) ? (slash + 1) : cardPath;
+/* Connector ids gathered from one drained batch of udev events. */
+#define HDMI_WATCHER_MAX_EVENT_CONNECTORS DS_MAX_HDMI_CONNECTORS
 
-    snprintf(cardName, len, "%s", base);
+/*
+ * Connection edges are debounced: a change is delivered only once the state has held
+ * for the settle window (DSHAL_HDMI_DEBOUNCE_MS, milliseconds; 0 delivers immediately).
+ * Edges that flip back inside the window are counted as suppressed.
+ */
+#define HDMI_WATCHER_DEBOUNCE_MS_DEFAULT 300
+
+typedef struct {
+    bool pending;               /* An edge is waiting for the window to expire */
+    bool connected;             /* Latest observed state while pending */
+    bool edidChanged;           /* EDID hash changed during the window */
+    unsigned int edges;         /* Edges observed during the window */
+    uint64_t deadlineMs;        /* CLOCK_MONOTONIC */
+} hdmiDebounce_t;
+
+static pthread_mutex_t gHdmiHotplugStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+static dsHdmiHotplugStats_t gHdmiHotplugStats = {0};
+
+static int hdmi_watcher_debounce_ms(void)
+{
+    const char *value = getenv("DSHAL_HDMI_DEBOUNCE_MS");
+    char *end = NULL;
+    long ms;
+
+    if (value == NULL || value[0] == '\0') {
+        return HDMI_WATCHER_DEBOUNCE_MS_DEFAULT;
+    }
+    ms = strtol(value, &end, 10);
+    if (*end != '\0' || ms < 0 || ms > INT_MAX) {
+        hal_warn("Ignoring invalid DSHAL_HDMI_DEBOUNCE_MS=%s\n", value);
+        return HDMI_WATCHER_DEBOUNCE_MS_DEFAULT;
+    }
+    return (int)ms;
 }
 
-static bool drm_get_hdmi_connector_state(bool *connected, bool *enabled)
+static uint64_t hdmi_watcher_now_ms(void)
 {
-    return dsGetHdmiConnectorState(connected, enabled);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
 }
 
-/* HDMI connection watcher thread state (udev + libdrm) */
-static pthread_t gHdmiWatcherThread = (pthread_t)(-1);
-static atomic_bool gHdmiWatcherRunning = ATOMIC_VAR_INIT(false);
-static pthread_t gInitialStateReporterThread = (pthread_t)(-1);
-static bool gLastHdmiConnected = false;
-static pthread_mutex_t gHdmiWatcherMutex = PTHREAD_MUTEX_INITIALIZER;
-static struct udev *gUdevCtx = NULL;
-static struct udev_monitor *gUdevMonitor = NULL;
-static int gUdevFd = -1;
+/* Records a state read; any change (re)starts the settle window. */
+static void hdmi_debounce_observe(hdmiDebounce_t *debounce, bool lastConnected, bool connected,
+        bool edidChanged, int windowMs)
+{
+    bool previous = debounce->pending ? debounce->connected : lastConnected;
+
+    if (connected == previous && !edidChanged) {
+        return;
+    }
+    if (connected != previous) {
+        debounce->edges++;
+        pthread_mutex_lock(&gHdmiHotplugStatsMutex);
+        gHdmiHotplugStats.transitionsObserved++;
+        pthread_mutex_unlock(&gHdmiHotplugStatsMutex);
+    }
+    debounce->pending = true;
+    debounce->connected = connected;
+    debounce->edidChanged = debounce->edidChanged || edidChanged;
+    debounce->deadlineMs = hdmi_watcher_now_ms() + (uint64_t)windowMs;
+}
+
+/*
+ * Display/audio event dispatch. The watcher is the only producer and the dispatcher
+ * thread the only consumer of a bounded lock-free ring, so a slow client callback
+ * never delays hotplug detection. When the ring is full the producer stops queueing
+ * and only records the latest connection state, which the consumer delivers after
+ * draining the ring.
+ */
+#define HDMI_EVENT_QUEUE_DEPTH 16
+
+typedef struct {
+    bool connected;             /* Settled connection state to report */
+} hdmiEvent_t;
+
+typedef struct {
+    hdmiEvent_t slots[HDMI_EVENT_QUEUE_DEPTH];
+    atomic_uint head;           /* Next slot to consume; written by the dispatcher */
+    atomic_uint tail;           /* Next slot to fill; written by the watcher */
+    atomic_bool overflow;       /* Ring was full; latestConnected holds the newest state */
+    atomic_bool latestConnected;
+} hdmiEventQueue_t;
+
+static hdmiEventQueue_t gHdmiEventQueue = {
+    .head = ATOMIC_VAR_INIT(0),
+    .tail = ATOMIC_VAR_INIT(0),
+    .overflow = ATOMIC_VAR_INIT(false),
+    .latestConnected = ATOMIC_VAR_INIT(false),
+};
+static pthread_t gHdmiDispatchThread = (pthread_t)(-1);
+static atomic_bool gHdmiDispatchRunning = ATOMIC_VAR_INIT(false);
+static int gHdmiDispatchWakeFd = -1;
+/* Set by dsRegisterDisplayEventCallback(); the dispatcher then re-announces the settled state. */
+static atomic_bool gHdmiDispatchReplay = ATOMIC_VAR_INIT(false);
+/* Last connection state the dispatcher reported; only the dispatcher thread touches it while running. */
+static bool gHdmiDispatchedConnected = false;
+
+/* Producer side; called from the watcher thread only. */
+static void hdmi_event_queue_push(bool connected)
+{
+    hdmiEventQueue_t *q = &gHdmiEventQueue;
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    if (atomic_load_explicit(&q->overflow, memory_order_acquire) || (tail - head) == HDMI_EVENT_QUEUE_DEPTH) {
+        /* Collapse to the latest state until the dispatcher catches up. */
+        atomic_store_explicit(&q->latestConnected, connected, memory_order_relaxed);
+        atomic_store_explicit(&q->overflow, true, memory_order_release);
+        pthread_mutex_lock(&gHdmiHotplugStatsMutex);
+        gHdmiHotplugStats.eventsCollapsed++;
+        pthread_mutex_unlock(&gHdmiHotplugStatsMutex);
+    } else {
+        q->slots[tail % HDMI_EVENT_QUEUE_DEPTH].connected = connected;
+        atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    }
+
+    if (gHdmiDispatchWakeFd >= 0 && !hdmi_eventfd_signal(gHdmiDispatchWakeFd)) {
+        hal_err("HDMI dispatcher not woken; queued events wait for the next hotplug\n");
+    }
+}
+
+/* Consumer side; called from the dispatcher thread only. */
+static bool hdmi_event_queue_pop(hdmiEvent_t *event)
+{
+    hdmiEventQueue_t *q = &gHdmiEventQueue;
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    if (head == tail) {
+        if (!atomic_exchange_explicit(&q->overflow, false, memory_order_acquire)) {
+            return false;
+        }
+        event->connected = atomic_load_explicit(&q->latestConnected, memory_order_relaxed);
+        return true;
+    }
+
+    *event = q->slots[head % HDMI_EVENT_QUEUE_DEPTH];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+/*
+ * A change of state is published as CONNECTED/DISCONNECTED. An event that repeats a
+ * connected state means the EDID changed, and re-announces CONNECTED because there is
+ * no EDID-changed display event. Each event is fanned out once to all subscribers.
+ */
+static void hdmi_dispatch_event(const hdmiEvent_t *event)
+{
+    dsDisplayEventInfo_t info;
+    bool transition = (event->connected != gHdmiDispatchedConnected);
+
+    if (!transition && !event->connected) {
+        return;
+    }
+
+    gHdmiDispatchedConnected = event->connected;
+    info.event = event->connected ? dsDISPLAY_EVENT_CONNECTED : dsDISPLAY_EVENT_DISCONNECTED;
+    info.connected = event->connected;
+    info.stateChanged = transition;
+    if (!transition) {
+        hal_info("EDID changed while connected, re-announcing CONNECTED event\n");
+    }
+    dsDisplayEventPublish(&info);
+}
+
+/* Subscriber for the dsRegisterDisplayEventCallback() client; userData is the native handle. */
+static void display_client_event(const dsDisplayEventInfo_t *info, void *userData)
+{
+    unsigned char eventData = 0;
+    dsDisplayEventCallback_t callback = NULL;
+
+    pthread_mutex_lock(&gHdmiWatcherMutex);
+    callback = _halcallback;
+    pthread_mutex_unlock(&gHdmiWatcherMutex);
+
+    /* Invoke callbacks outside lock to avoid callback re-entry deadlock. */
+    if (NULL == callback) {
+        if (info->stateChanged) {
+            hal_warn("_halcallback is NULL, cannot report event\n");
+        }
+        return;
+    }
+    hal_dbg("Reporting HDMI %s event\n", info->connected ? "CONNECTED" : "DISCONNECTED");
+    callback((int)(intptr_t)userData, info->event, &eventData);
+}
+
+/* Announces the given state to all subscribers, e.g. as the initial state for a new client. */
+static void hdmi_announce_state(bool connected)
+{
+    dsDisplayEventInfo_t info = {
+        .event = connected ? dsDISPLAY_EVENT_CONNECTED : dsDISPLAY_EVENT_DISCONNECTED,
+        .connected = connected,
+        .stateChanged = true,
+    };
+
+    hal_info("Announcing current HDMI state: connected=%d\n", connected);
+    dsDisplayEventPublish(&info);
+}
+
+static void* hdmi_dispatch_thread(void *arg)
+{
+    hdmiEvent_t event;
+
+    (void)arg;
+
+    hal_info("HDMI event dispatcher thread started\n");
+
+    while (atomic_load(&gHdmiDispatchRunning)) {
+        uint64_t value;
+        if (read(gHdmiDispatchWakeFd, &value, sizeof(value)) < 0 && errno != EINTR) {
+            hal_err("HDMI dispatcher eventfd read failed: %s\n", strerror(errno));
+            break;
+        }
+        while (atomic_load(&gHdmiDispatchRunning) && hdmi_event_queue_pop(&event)) {
+            hdmi_dispatch_event(&event);
+        }
+        /* After the queue, so the announced state is the one clients will see next. */
+        if (atomic_load(&gHdmiDispatchRunning) && atomic_exchange(&gHdmiDispatchReplay, false)) {
+            hdmi_announce_state(gHdmiDispatchedConnected);
+        }
+    }
+
+    hal_info("HDMI event dispatcher thread terminated\n");
+    return NULL;
+}
+
+static bool start_hdmi_dispatcher(bool initialConnected)
+{
+    atomic_store(&gHdmiEventQueue.head, 0);
+    atomic_store(&gHdmiEventQueue.tail, 0);
+    atomic_store(&gHdmiEventQueue.overflow, false);
+    atomic_store(&gHdmiDispatchReplay, false);
+    gHdmiDispatchedConnected = initialConnected;
+
+    gHdmiDispatchWakeFd = eventfd(0, EFD_CLOEXEC);
+    if (gHdmiDispatchWakeFd < 0) {
+        hal_err("Failed to create HDMI dispatcher eventfd: %s\n", strerror(errno));
+        return false;
+    }
+
+    atomic_store(&gHdmiDispatchRunning, true);
+    int ret = pthread_create(&gHdmiDispatchThread, NULL, hdmi_dispatch_thread, NULL);
+    if (ret != 0) {
+        hal_err("Failed to create HDMI dispatcher thread: %d\n", ret);
+        atomic_store(&gHdmiDispatchRunning, false);
+        close(gHdmiDispatchWakeFd);
+        gHdmiDispatchWakeFd = -1;
+        return false;
+    }
+    return true;
+}
+
+/* Pending events are dropped; by now the client callback has been cleared. */
+static void stop_hdmi_dispatcher(void)
+{
+    if (!atomic_load(&gHdmiDispatchRunning)) {
+        return;
+    }
+
+    atomic_store(&gHdmiDispatchRunning, false);
+    if (!hdmi_eventfd_signal(gHdmiDispatchWakeFd)) {
+        /* The thread stays blocked on the eventfd, so leave both to it rather than hang here. */
+        hal_err("Cannot wake the HDMI dispatcher; detaching it\n");
+        pthread_detach(gHdmiDispatchThread);
+        gHdmiDispatchThread = (pthread_t)(-1);
+        gHdmiDispatchWakeFd = -1;
+        return;
+    }
+
+    int ret = pthread_join(gHdmiDispatchThread, NULL);
+    if (ret != 0) {
+        hal_err("Failed to join HDMI dispatcher thread: %d\n", ret);
+    }
+    gHdmiDispatchThread = (pthread_t)(-1);
+
+    close(gHdmiDispatchWakeFd);
+    gHdmiDispatchWakeFd = -1;
+}
+
+/* Hands the settled state to the dispatcher and updates the counters. */
+static void hdmi_watcher_deliver(bool *lastConnected, const hdmiDebounce_t *debounce)
+{
+    bool stateChanged = (debounce->connected != *lastConnected);
+    bool edidChanged = debounce->edidChanged && debounce->connected;
+    unsigned int delivered = stateChanged ? 1u : 0u;
+
+    pthread_mutex_lock(&gHdmiHotplugStatsMutex);
+    gHdmiHotplugStats.transitionsDelivered += delivered;
+    gHdmiHotplugStats.transitionsSuppressed += debounce->edges - delivered;
+    pthread_mutex_unlock(&gHdmiHotplugStatsMutex);
+    if (debounce->edges > delivered) {
+        hal_info("HDMI debounce suppressed %u transition(s), settled connected=%d\n",
+                debounce->edges - delivered, debounce->connected);
+    }
+
+    if (stateChanged) {
+        hal_info("HDMI connection state changed: connected=%d (was %d)\n", debounce->connected, *lastConnected);
+        *lastConnected = debounce->connected;
+        pthread_mutex_lock(&gHdmiWatcherMutex);
+        gLastHdmiConnected = debounce->connected;
+        pthread_mutex_unlock(&gHdmiWatcherMutex);
+    }
+
+    if (stateChanged || edidChanged) {
+        hdmi_event_queue_push(debounce->connected);
+    }
+}
 
 static void* hdmi_watcher_thread(void *arg)
 {
-    int nativeHandle = (int)(intptr_t)arg;
+    (void)arg;
     bool currentConnected = false, currentEnabled = false;
     bool lastConnected = false;
-    unsigned char eventData = 0;
+    hdmiDebounce_t debounce = {0};
 
     pthread_mutex_lock(&gHdmiWatcherMutex);
     lastConnected = gLastHdmiConnected;
     pthread_mutex_unlock(&gHdmiWatcherMutex);
 
-    hal_info("HDMI watcher thread (udev + libdrm) started\n");
+    int safetyPollMs = hdmi_watcher_safety_poll_ms();
+    int debounceMs = hdmi_watcher_debounce_ms();
+
+    hal_info("HDMI watcher thread (udev + libdrm) started, safety poll %d ms, debounce %d ms\n",
+            safetyPollMs, debounceMs);
 
     while (atomic_load(&gHdmiWatcherRunning)) {
-        /* Wait for udev DRM hotplug notifications and poll periodically as a safety net. */
-        struct pollfd pfd = {0};
-        pfd.fd = gUdevFd;
-        pfd.events = POLLIN;
-
-        int poll_result = poll(&pfd, 1, 250);  /* 250ms timeout */
-        if (poll_result > 0 && (pfd.revents & POLLIN)) {
-            struct udev_device *dev = udev_monitor_receive_device(gUdevMonitor);
-            if (dev) {
-                const char *subsystem = udev_device_get_subsystem(dev);
-                const char *sysname = udev_device_get_sysname(dev);
-                const char *action = udev_device_get_action(dev);
-
-                if (subsystem && strcmp(subsystem, "drm") == 0) {
-                    hal_dbg("udev DRM event: action=%s sysname=%s\n",
-                            action ? action : "unknown",
-                            sysname ? sysname : "unknown");
-                }
-                udev_device_unref(dev);
+        /* Block on udev DRM notifications and the shutdown eventfd. */
+        struct pollfd pfds[2] = {
+            { .fd = gUdevFd, .events = POLLIN },
+            { .fd = gHdmiWatcherWakeFd, .events = POLLIN },
+        };
+        bool rescan = false;
+        bool fullScan = false;
+        uint32_t connectorIds[HDMI_WATCHER_MAX_EVENT_CONNECTORS];
+        int connectorCount = 0;
+        int timeoutMs = (safetyPollMs > 0) ? safetyPollMs : -1;
+
+        /* Wake up when a pending edge settles. */
+        if (debounce.pending) {
+            uint64_t now = hdmi_watcher_now_ms();
+            int remaining = (debounce.deadlineMs > now) ? (int)(debounce.deadlineMs - now) : 0;
+            if (timeoutMs < 0 || remaining < timeoutMs) {
+                timeoutMs = remaining;
             }
-        } else if (poll_result < 0 && errno != EINTR) {
-            hal_err("poll error: %s\n", strerror(errno));
-            struct timespec ts = {.tv_sec = 0, .tv_nsec = 1000000};  /* 1ms sleep on error */
-            nanosleep(&ts, NULL);
         }
 
-        /* Refresh connector state for both udev events and timeout wakeups. */
-        if (drm_get_hdmi_connector_state(&currentConnected, &currentEnabled)) {
-            bool stateChanged = false;
-            bool notifyConnected = false;
-            dsDisplayEventCallback_t callback = NULL;
-
-            pthread_mutex_lock(&gHdmiWatcherMutex);
-
-            /* Detect state change and snapshot callback under lock. */
-            if (currentConnected != lastConnected) {
-                hal_info("HDMI connection state changed: connected=%d (was %d)\n", currentConnected, lastConnected);
-                lastConnected = currentConnected;
-                gLastHdmiConnected = currentConnected;
-                callback = _halcallback;
-                stateChanged = true;
-                notifyConnected = currentConnected;
+        int poll_result = poll(pfds, 2, timeoutMs);
+        if (poll_result < 0) {
+            if (errno != EINTR) {
+                hal_err("poll error: %s\n", strerror(errno));
+                struct timespec ts = {.tv_sec = 0, .tv_nsec = 1000000};  /* 1ms sleep on error */
+                nanosleep(&ts, NULL);
             }
+            continue;
+        }
+        if (poll_result == 0 && !debounce.pending) {
+            rescan = true;  /* Safety poll timeout */
+            fullScan = true;
+        }
+        if (pfds[1].revents & POLLIN) {
+            hdmi_eventfd_drain(gHdmiWatcherWakeFd);
+        }
+        if (!atomic_load(&gHdmiWatcherRunning)) {
+            break;
+        }
+        if (pfds[0].revents & POLLIN) {
+            struct udev_device *dev;
+            /* Drain everything queued so a burst of events costs one re-scan. */
+            while ((dev = udev_monitor_receive_device(gUdevMonitor)) != NULL) {
+                if (hdmi_watcher_is_hotplug_event(dev)) {
+                    uint32_t connectorId = 0;
+                    rescan = true;
+                    pthread_mutex_lock(&gHdmiHotplugStatsMutex);
+                    gHdmiHotplugStats.hotplugEvents++;
+                    pthread_mutex_unlock(&gHdmiHotplugStatsMutex);
+                    if (!hdmi_watcher_event_connector(dev, &connectorId) ||
+                            connectorCount == HDMI_WATCHER_MAX_EVENT_CONNECTORS) {
+                        fullScan = true;
+                    } else {
+                        bool seen = false;
+                        for (int i = 0; i < connectorCount; i++) {
+                            seen = seen || (connectorIds[i] == connectorId);
+                        }
+                        if (!seen) {
+                            connectorIds[connectorCount++] = connectorId;
+                        }
+                    }
+                }
+                udev_device_unref(dev);
+            }
+        }
 
-            pthread_mutex_unlock(&gHdmiWatcherMutex);
-
-            /* Invoke callbacks outside lock to avoid callback re-entry deadlock. */
-            if (stateChanged) {
-                if (NULL != callback) {
-                    if (notifyConnected) {
-                        hal_dbg("HDMI cable connected, triggering CONNECTED event\n");
-                        callback(nativeHandle, dsDISPLAY_EVENT_CONNECTED, &eventData);
+        if (rescan) {
+            /*
+             * Events naming a connector refresh only that connector (non-HDMI ids are
+             * ignored); events without CONNECTOR and safety-poll timeouts re-scan all of them.
+             */
+            bool haveState = false;
+            if (fullScan) {
+                dsDrmContextInvalidate();
+                haveState = dsGetHdmiConnectorState(&currentConnected, &currentEnabled);
+            } else {
+                for (int i = 0; i < connectorCount; i++) {
+                    if (dsRefreshHdmiConnectorState(connectorIds[i], &currentConnected, &currentEnabled)) {
+                        haveState = true;
                     } else {
-                        hal_dbg("HDMI cable disconnected, triggering DISCONNECTED event\n");
-                        callback(nativeHandle, dsDISPLAY_EVENT_DISCONNECTED, &eventData);
+                        hal_dbg("Ignoring hotplug for non-HDMI connector %u\n", connectorIds[i]);
                     }
-                } else {
-                    hal_warn("_halcallback is NULL, cannot report event\n");
                 }
+            }
+
+            if (haveState) {
+                bool edidChanged = false;
 
-                notify_audio_hotplug(notifyConnected);
+                /* Read the EDID once per hotplug; every EDID query is served from this copy. */
+                (void)dsEdidCacheRefresh(&edidChanged);
+                hdmi_debounce_observe(&debounce, lastConnected, currentConnected, edidChanged, debounceMs);
             }
         }
+
+        if (debounce.pending && hdmi_watcher_now_ms() >= debounce.deadlineMs) {
+            hdmi_watcher_deliver(&lastConnected, &debounce);
+            memset(&debounce, 0, sizeof(debounce));
+        }
     }
 
     hal_info("HDMI watcher thread (udev + libdrm) terminated\n");
     return NULL;
 }
 
-static bool start_hdmi_watcher(int nativeHandle)
+static bool start_hdmi_watcher(void)
 {
     if (atomic_load(&gHdmiWatcherRunning)) {
         hal_warn("HDMI watcher already running\n");
         return true;
     }
 
-    bool initialConnected = false;
-    bool initialEnabled = false;
-
-    if (drm_get_hdmi_connector_state(&initialConnected, &initialEnabled)) {
-        pthread_mutex_lock(&gHdmiWatcherMutex);
-        gLastHdmiConnected = initialConnected;
-        pthread_mutex_unlock(&gHdmiWatcherMutex);
-        hal_info("Initial DRM HDMI state: connected=%d enabled=%d\n", initialConnected, initialEnabled);
-    }
-
     gUdevCtx = udev_new();
     if (!gUdevCtx) {
         hal_err("Failed to initialize udev context\n");
@@ -242,11 +643,48 @@ static bool start_hdmi_watcher(int nativeHandle)
         return false;
     }
 
+    gHdmiWatcherWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (gHdmiWatcherWakeFd < 0) {
+        hal_err("Failed to create HDMI watcher eventfd: %s\n", strerror(errno));
+        gUdevFd = -1;
+        udev_monitor_unref(gUdevMonitor);
+        gUdevMonitor = NULL;
+        udev_unref(gUdevCtx);
+        gUdevCtx = NULL;
+        return false;
+    }
+
+    /* Read the initial state only once the monitor is receiving, so no hotplug falls in between. */
+    bool initialConnected = false;
+    bool initialEnabled = false;
+
+    if (dsGetHdmiConnectorState(&initialConnected, &initialEnabled)) {
+        pthread_mutex_lock(&gHdmiWatcherMutex);
+        gLastHdmiConnected = initialConnected;
+        pthread_mutex_unlock(&gHdmiWatcherMutex);
+        hal_info("Initial DRM HDMI state: connected=%d enabled=%d\n", initialConnected, initialEnabled);
+        (void)dsEdidCacheRefresh(NULL);
+    }
+
+    if (!start_hdmi_dispatcher(initialConnected)) {
+        close(gHdmiWatcherWakeFd);
+        gHdmiWatcherWakeFd = -1;
+        gUdevFd = -1;
+        udev_monitor_unref(gUdevMonitor);
+        gUdevMonitor = NULL;
+        udev_unref(gUdevCtx);
+        gUdevCtx = NULL;
+        return false;
+    }
+
     atomic_store(&gHdmiWatcherRunning, true);
-    int ret = pthread_create(&gHdmiWatcherThread, NULL, hdmi_watcher_thread, (void *)(intptr_t)nativeHandle);
+    int ret = pthread_create(&gHdmiWatcherThread, NULL, hdmi_watcher_thread, NULL);
     if (ret != 0) {
         hal_err("Failed to create HDMI watcher thread: %d\n", ret);
         atomic_store(&gHdmiWatcherRunning, false);
+        stop_hdmi_dispatcher();
+        close(gHdmiWatcherWakeFd);
+        gHdmiWatcherWakeFd = -1;
         gUdevFd = -1;
         udev_monitor_unref(gUdevMonitor);
         gUdevMonitor = NULL;
@@ -255,6 +693,7 @@ static bool start_hdmi_watcher(int nativeHandle)
         return false;
     }
 
+    dsHdmiSnapshotSetLive(true);
     hal_info("HDMI watcher thread (udev + libdrm) created successfully\n");
     return true;
 }
@@ -265,7 +704,11 @@ static bool stop_hdmi_watcher(void)
         return true;
     }
 
+    dsHdmiSnapshotSetLive(false);
     atomic_store(&gHdmiWatcherRunning, false);
+    if (gHdmiWatcherWakeFd >= 0) {
+        (void)hdmi_eventfd_signal(gHdmiWatcherWakeFd);
+    }
 
     if (gHdmiWatcherThread != (pthread_t)(-1)) {
         int ret = pthread_join(gHdmiWatcherThread, NULL);
@@ -275,8 +718,15 @@ static bool stop_hdmi_watcher(void)
         gHdmiWatcherThread = (pthread_t)(-1);
     }
 
+    if (gHdmiWatcherWakeFd >= 0) {
+        close(gHdmiWatcherWakeFd);
+        gHdmiWatcherWakeFd = -1;
+    }
     gUdevFd = -1;
 
+    /* The watcher was the only producer, so the dispatcher can go now. */
+    stop_hdmi_dispatcher();
+
     if (gUdevMonitor) {
         udev_monitor_unref(gUdevMonitor);
         gUdevMonitor = NULL;
@@ -291,119 +741,37 @@ static bool stop_hdmi_watcher(void)
     return true;
 }
 
-/* Structure to pass data to the initial state reporter thread */
-typedef struct {
-    int nativeHandle;
-    dsDisplayEventCallback_t callback;
-} initial_state_reporter_args_t;
-
-/* One-shot thread to report the current HDMI state when callback is registered */
-static void* report_initial_hdmi_state(void *arg)
+/*
+ * Reports the current state to a newly registered client. With the dispatcher running
+ * the report is queued behind pending events, so it never races a hotplug and runs off
+ * the caller's thread. Without it, or if it cannot be woken, the cached state is
+ * reported from the caller.
+ */
+static void report_initial_hdmi_state(void)
 {
-    initial_state_reporter_args_t *args = (initial_state_reporter_args_t *)arg;
-    int nativeHandle = args->nativeHandle;
-    dsDisplayEventCallback_t callback = args->callback;
     bool currentConnected = false, currentEnabled = false;
-    unsigned char eventData = 0;
-
-    free(args);
-
-    /* Small delay to ensure watcher thread is fully initialized */
-    struct timespec ts = {0, 50 * 1000 * 1000}; /* 50ms */
-    (void)nanosleep(&ts, NULL);
-
-    hal_info("Initial state reporter thread: querying current HDMI state\n");
 
-    /* Guard: skip callbacks if the display module was terminated during the delay. */
-    pthread_mutex_lock(&gHdmiWatcherMutex);
-    bool initialized = _bDisplayInited;
-    pthread_mutex_unlock(&gHdmiWatcherMutex);
-
-    if (!initialized) {
-        hal_warn("Initial state reporter: display already terminated, skipping callback\n");
-        hal_info("Initial state reporter thread: exiting\n");
-        return NULL;
+    if (atomic_load(&gHdmiDispatchRunning)) {
+        atomic_store(&gHdmiDispatchReplay, true);
+        if (hdmi_eventfd_signal(gHdmiDispatchWakeFd)) {
+            return;
+        }
+        /* Not woken: report from here, unless the dispatcher already took the request. */
+        if (!atomic_exchange(&gHdmiDispatchReplay, false)) {
+            return;
+        }
+        hal_warn("HDMI dispatcher not woken; reporting the initial state synchronously\n");
     }
 
     if (drm_get_hdmi_connector_state(&currentConnected, &currentEnabled)) {
-        hal_info("Initial HDMI state: connected=%d enabled=%d\n", currentConnected, currentEnabled);
-        if (callback != NULL) {
-            if (currentConnected) {
-                hal_dbg("Reporting initial HDMI CONNECTED state\n");
-                callback(nativeHandle, dsDISPLAY_EVENT_CONNECTED, &eventData);
-                notify_audio_hotplug(true);
-            } else {
-                hal_dbg("Reporting initial HDMI DISCONNECTED state\n");
-                callback(nativeHandle, dsDISPLAY_EVENT_DISCONNECTED, &eventData);
-                notify_audio_hotplug(false);
-            }
-        } else {
-            notify_audio_hotplug(currentConnected);
-        }
+        hdmi_announce_state(currentConnected);
     } else {
         hal_err("Failed to query initial HDMI state\n");
     }
-
-    hal_info("Initial state reporter thread: exiting\n");
-    return NULL;
 }
 
-
-static dsError_t dsQueryHdmiResolution(const unsigned char *edid_raw, int edid_len);
+static dsError_t dsQueryHdmiResolution(const dshalEdidCapabilities_t *caps);
 static bool drm_get_preferred_hdmi_mode(char *mode, size_t len);
-static dsVideoPortResolution_t *dsgetResolutionInfo(const char *res_name);
-
-typedef struct {
-    dsVideoPortResolution_t *hdmiSupportedResolution;
-    unsigned int *numSupportedResn;
-} HdmiResolutionParseContext_t;
-
-static bool parseHdmiResolutionsFromCtaDataBlock(int tag,
-        const unsigned char *data,
-        int dataLen,
-        void *context)
-{
-    HdmiResolutionParseContext_t *ctx = (HdmiResolutionParseContext_t *)context;
-
-    if (ctx == NULL || ctx->hdmiSupportedResolution == NULL ||
-            ctx->numSupportedResn == NULL || data == NULL) {
-        return false;
-    }
-
-    if (tag != DSHAL_EDID_CTA_DATA_BLOCK_TAG_VIDEO || dataLen <= 0) {
-        return false;
-    }
-
-    for (int s = 0; s < dataLen; s++) {
-        int vic = data[s] & 0x7F;
-        for (size_t i = 0; i < noOfItemsInResolutionMap; i++) {
-            if (resolutionMap[i].mode != vic) {
-                continue;
-            }
-            dsVideoPortResolution_t *res = dsgetResolutionInfo(resolutionMap[i].rdkRes);
-            if (!res) {
-                continue;
-            }
-            bool alreadyAdded = false;
-            for (unsigned int j = 0; j < *(ctx->numSupportedResn); j++) {
-                if (strncmp(ctx->hdmiSupportedResolution[j].name, res->name,
-                            sizeof(ctx->hdmiSupportedResolution[j].name)) == 0) {
-                    alreadyAdded = true;
-                    break;
-                }
-            }
-            if (!alreadyAdded) {
-                memcpy(&ctx->hdmiSupportedResolution[*(ctx->numSupportedResn)], res,
-                       sizeof(dsVideoPortResolution_t));
-                hal_dbg("EDID resolution '%s' (VIC %d)\n",
-                        ctx->hdmiSupportedResolution[*(ctx->numSupportedResn)].name, vic);
-                (*(ctx->numSupportedResn))++;
-            }
-        }
-    }
-
-    return false;
-}
 
 typedef struct _VDISPHandle_t {
     dsVideoPortType_t m_vType;
@@ -426,6 +794,13 @@ bool dsIsValidVDispHandle(intptr_t m_handle) {
 
 static bool drm_get_preferred_hdmi_mode(char *mode, size_t len)
 {
+    dsHdmiSnapshot_t snapshot;
+
+    if (mode != NULL && len > 0 && dsGetHdmiSnapshot(&snapshot) &&
+            snapshot.connected && snapshot.preferredMode[0] != '\0') {
+        snprintf(mode, len, "%s", snapshot.preferredMode);
+        return true;
+    }
     return dsGetPreferredHdmiMode(mode, len);
 }
 
@@ -448,11 +823,27 @@ dsError_t dsDisplayInit()
     _VDispHandles[dsVIDEOPORT_TYPE_HDMI][0].m_nativeHandle = dsVIDEOPORT_TYPE_HDMI;
     _VDispHandles[dsVIDEOPORT_TYPE_HDMI][0].m_index = 0;
 
+    _bDrmContextHeld = dsDrmContextAcquire();
+    if (!_bDrmContextHeld) {
+        hal_warn("Shared DRM context unavailable, DRM queries will open the card per call\n");
+    }
+    dsResolutionIndexInit();
+
     /* Query resolution information without TVService dependency. */
-    dsQueryHdmiResolution(NULL, 0);
+    dsQueryHdmiResolution(NULL);
+
+    pthread_mutex_lock(&gHdmiHotplugStatsMutex);
+    memset(&gHdmiHotplugStats, 0, sizeof(gHdmiHotplugStats));
+    pthread_mutex_unlock(&gHdmiHotplugStatsMutex);
+
+    if (dsDisplayEventSubscribe(display_client_event,
+            (void *)(intptr_t)_VDispHandles[dsVIDEOPORT_TYPE_HDMI][0].m_nativeHandle, &_displayClientToken) != dsERR_NONE) {
+        hal_err("Failed to subscribe the display event callback\n");
+        _displayClientToken = 0;
+    }
 
     /* Start HDMI connection watcher thread */
-    if (!start_hdmi_watcher(_VDispHandles[dsVIDEOPORT_TYPE_HDMI][0].m_nativeHandle)) {
+    if (!start_hdmi_watcher()) {
         hal_warn("Failed to start HDMI watcher thread, continuing without active monitoring\n");
     }
 
@@ -809,29 +1200,8 @@ dsError_t dsRegisterDisplayEventCallback(intptr_t handle, dsDisplayEventCallback
     _halcallback = cb;
     pthread_mutex_unlock(&gHdmiWatcherMutex);
 
-    /* Spawn a one-shot thread to report the current HDMI state immediately */
-    initial_state_reporter_args_t *args = (initial_state_reporter_args_t *)malloc(sizeof(initial_state_reporter_args_t));
-    if (args == NULL) {
-        hal_err("Failed to allocate memory for initial state reporter thread args\n");
-        return dsERR_GENERAL;
-    }
-
-    args->nativeHandle = vDispHandle->m_nativeHandle;
-    args->callback = cb;
-
-    pthread_t reporter_thread;
-    int ret = pthread_create(&reporter_thread, NULL, report_initial_hdmi_state, (void *)args);
-    if (ret != 0) {
-        hal_err("Failed to create initial state reporter thread: %d\n", ret);
-        free(args);
-        return dsERR_GENERAL;
-    }
-
-    /* Store thread handle for joining in dsDisplayTerm() to prevent
-     * callbacks from firing after display module termination. */
-    gInitialStateReporterThread = reporter_thread;
-
-    hal_dbg("Initial state reporter thread spawned\n");
+    /* Report the current HDMI state immediately */
+    report_initial_hdmi_state();
     return dsERR_NONE;
 }
 
@@ -878,6 +1248,7 @@ dsError_t dsGetEDID(intptr_t handle, dsDisplayEDID_t *edid)
         return dsERR_NONE;
     }
 
+    dshalEdidCapabilities_t caps;
     unsigned char *raw = (unsigned char *)calloc(MAX_EDID_BYTES_LEN, sizeof(unsigned char));
     if (raw == NULL) {
         hal_err("Failed to allocate EDID buffer\n");
@@ -906,9 +1277,13 @@ dsError_t dsGetEDID(intptr_t handle, dsDisplayEDID_t *edid)
         edid->physicalAddressB = 0;
         edid->physicalAddressC = 0;
         edid->physicalAddressD = 0;
-        strncpy(edid->monitorName, "Unknown", sizeof(edid->monitorName));
+        if (!dsEdidCacheGetCapabilities(&caps)) {
+            memset(&caps, 0, sizeof(caps));
+        }
+        strncpy(edid->monitorName, (caps.monitorName[0] != '\0') ? caps.monitorName : "Unknown",
+                sizeof(edid->monitorName));
         edid->monitorName[dsEEDID_MAX_MON_NAME_LENGTH - 1] = '\0';
-        if (dsQueryHdmiResolution(raw, length) != dsERR_NONE) {
+        if (dsQueryHdmiResolution(&caps) != dsERR_NONE) {
             hal_err("Failed to query HDMI resolution\n");
             ret = dsERR_GENERAL;
             goto cleanup;
@@ -950,23 +1325,25 @@ dsError_t dsDisplayTerm()
         return dsERR_NOT_INITIALIZED;
     }
 
-    /* Clear initialized flag and callback pointer under mutex so that both
-     * the initial-state reporter thread and the HDMI watcher thread stop
-     * firing client callbacks before we join/stop either thread. */
+    /* Clear initialized flag and callback pointer under mutex so that the
+     * dispatcher stops firing client callbacks before the watcher is stopped. */
     pthread_mutex_lock(&gHdmiWatcherMutex);
     _bDisplayInited = false;
     _halcallback = NULL;
     pthread_mutex_unlock(&gHdmiWatcherMutex);
 
-    /* Join the initial state reporter thread to ensure it has exited before
-     * we return and the caller potentially unloads the HAL. */
-    if (gInitialStateReporterThread != (pthread_t)(-1)) {
-        pthread_join(gInitialStateReporterThread, NULL);
-        gInitialStateReporterThread = (pthread_t)(-1);
-    }
-
     /* Stop HDMI connection watcher thread */
     stop_hdmi_watcher();
+    if (_displayClientToken != 0) {
+        (void)dsDisplayEventUnsubscribe(_displayClientToken);
+        _displayClientToken = 0;
+    }
+    if (_bDrmContextHeld) {
+        dsDrmContextRelease();
+        _bDrmContextHeld = false;
+    }
+    /* The display socket connection is shared; any later command reconnects. */
+    westerosGLConsoleClose();
 
     if (HdmiSupportedResolution) {
         free(HdmiSupportedResolution);
@@ -975,6 +1352,21 @@ dsError_t dsDisplayTerm()
     return dsERR_NONE;
 }
 
+dsError_t dsGetHdmiHotplugStats(dsHdmiHotplugStats_t *stats)
+{
+    if (false == _bDisplayInited) {
+        return dsERR_NOT_INITIALIZED;
+    }
+    if (stats == NULL) {
+        return dsERR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&gHdmiHotplugStatsMutex);
+    *stats = gHdmiHotplugStats;
+    pthread_mutex_unlock(&gHdmiHotplugStatsMutex);
+    return dsERR_NONE;
+}
+
 /**
  * @brief To get the native handle of the video display device
  *
@@ -1008,7 +1400,7 @@ dsError_t dsDisplaygetNativeHandle(intptr_t handle, int *native)
  *	Get The HDMI Resolution List
  *
  **/
-static dsError_t dsQueryHdmiResolution(const unsigned char *edid_raw, int edid_len)
+static dsError_t dsQueryHdmiResolution(const dshalEdidCapabilities_t *caps)
 {
     hal_info("Invoked\n");
 
@@ -1024,14 +1416,34 @@ static dsError_t dsQueryHdmiResolution(const unsigned char *edid_raw, int edid_l
         return dsERR_GENERAL;
     }
 
-    /* If we have EDID bytes, enumerate only resolutions whose VIC is advertised
-     * in the CTA-861 Video Data Block(s) of the connected display. */
-    if (edid_raw != NULL && edid_len >= DSHAL_EDID_BLOCK_SIZE) {
-        HdmiResolutionParseContext_t ctx = {
-            .hdmiSupportedResolution = HdmiSupportedResolution,
-            .numSupportedResn = &numSupportedResn,
-        };
-        (void)dshalEdidForEachCtaDataBlock(edid_raw, edid_len, parseHdmiResolutionsFromCtaDataBlock, &ctx);
+    /* If we have the EDID capabilities, enumerate only resolutions whose VIC is
+     * advertised in the CTA-861 Video Data Block(s) of the connected display. */
+    if (caps != NULL && caps->vicCount > 0) {
+        for (int v = 0; v < caps->vicCount; v++) {
+            int vic = caps->vics[v];
+            for (size_t i = 0; i < noOfItemsInResolutionMap; i++) {
+                if (resolutionMap[i].mode != vic) {
+                    continue;
+                }
+                const dsVideoPortResolution_t *res = dsResolutionSettingsByName(resolutionMap[i].rdkRes);
+                if (!res) {
+                    continue;
+                }
+                bool alreadyAdded = false;
+                for (unsigned int j = 0; j < numSupportedResn; j++) {
+                    if (strncmp(HdmiSupportedResolution[j].name, res->name,
+                                sizeof(HdmiSupportedResolution[j].name)) == 0) {
+                        alreadyAdded = true;
+                        break;
+                    }
+                }
+                if (!alreadyAdded) {
+                    memcpy(&HdmiSupportedResolution[numSupportedResn], res, sizeof(dsVideoPortResolution_t));
+                    hal_dbg("EDID resolution '%s' (VIC %d)\n", HdmiSupportedResolution[numSupportedResn].name, vic);
+                    numSupportedResn++;
+                }
+            }
+        }
 
         if (numSupportedResn > 0) {
             hal_dbg("Total EDID-based HDMI resolutions = %u\n", numSupportedResn);
@@ -1043,7 +1455,7 @@ static dsError_t dsQueryHdmiResolution(const unsigned char *edid_raw, int edid_l
     /* Static fallback: enumerate resolutionMap (deduped). */
     for (size_t i = 0; i < noOfItemsInResolutionMap; i++) {
         bool alreadyAdded = false;
-        dsVideoPortResolution_t *resolution = dsgetResolutionInfo(resolutionMap[i].rdkRes);
+        const dsVideoPortResolution_t *resolution = dsResolutionSettingsByName(resolutionMap[i].rdkRes);
 
         if (!resolution) {
             continue;
@@ -1069,18 +1481,6 @@ static dsError_t dsQueryHdmiResolution(const unsigned char *edid_raw, int edid_l
     return dsERR_NONE;
 }
 
-static dsVideoPortResolution_t* dsgetResolutionInfo(const char *res_name)
-{
-    hal_info("Invoked\n");
-    size_t iCount = kNumResolutionsSettings;
-    for (size_t i=0; i < iCount; i++) {
-        if (!strncmp(res_name, kResolutionsSettings[i].name, strlen(res_name))) {
-            return &kResolutionsSettings[i];
-        }
-    }
-    return NULL;
-}
-
 /**
  * @brief Gets the EDID buffer and EDID length of connected display device.
  *
@@ -1110,10 +1510,6 @@ dsError_t dsGetEDIDBytes(intptr_t handle, unsigned char *edid, int *length)
     hal_info("Invoked\n");
     VDISPHandle_t *vDispHandle = (VDISPHandle_t *)handle;
     bool drmConnected = false, drmEnabled = false;
-    char edid_path[PATH_MAX] = {0};
-    char status_path[PATH_MAX] = {0};
-    char connector_name[64] = {0};
-    char cardName[PATH_MAX] = {0};
 
     if (false == _bDisplayInited) {
         return dsERR_NOT_INITIALIZED;
@@ -1132,77 +1528,11 @@ dsError_t dsGetEDIDBytes(intptr_t handle, unsigned char *edid, int *length)
         return dsERR_NONE;
     }
 
-    /* Scan /sys/class/drm for active HDMI connector and read EDID binary */
-    resolve_drm_card_name(cardName, sizeof(cardName));
-    DIR *drm_class = opendir("/sys/class/drm");
-    if (!drm_class) {
-        hal_err("Failed to open /sys/class/drm\n");
-        return dsERR_GENERAL;
-    }
-
-    struct dirent *entry;
+    /* The watcher refreshes the cache on every hotplug; without it, the cache reads the display each time. */
     *length = 0;
-    while ((entry = readdir(drm_class)) != NULL) {
-        if (strncmp(entry->d_name, cardName, strlen(cardName)) != 0) {
-            continue; /* Skip entries not matching our card */
-        }
-        if (strstr(entry->d_name, "HDMI-A-1") == NULL) {
-            continue; /* Focus on HDMI0 connector only */
-        }
-
-        int status_len = snprintf(status_path, sizeof(status_path), "/sys/class/drm/%s/status", entry->d_name);
-        if (status_len < 0 || (size_t)status_len >= sizeof(status_path)) {
-            hal_warn("Status path truncated for connector '%s'\n", entry->d_name);
-            continue;
-        }
-
-        FILE *status_file = fopen(status_path, "r");
-        if (status_file == NULL) {
-            hal_warn("Failed to open connector status at %s\n", status_path);
-            continue;
-        }
-
-        char status[16] = {0};
-        if (fgets(status, sizeof(status), status_file) == NULL) {
-            fclose(status_file);
-            hal_warn("Failed to read connector status from %s\n", status_path);
-            continue;
-        }
-        fclose(status_file);
-
-        if (strncmp(status, "connected", strlen("connected")) != 0) {
-            hal_dbg("Skipping disconnected connector %s (status=%s)\n", entry->d_name, status);
-            continue;
-        }
-
-        int path_len = snprintf(edid_path, sizeof(edid_path), "/sys/class/drm/%s/edid", entry->d_name);
-        if (path_len < 0 || (size_t)path_len >= sizeof(edid_path)) {
-            hal_warn("EDID path truncated for connector '%s'\n", entry->d_name);
-            continue;
-        }
-        FILE *edid_file = fopen(edid_path, "rb");
-        if (!edid_file) {
-            hal_dbg("EDID file not found at %s\n", edid_path);
-            continue;
-        }
-
-        *length = (int)fread(edid, 1, MAX_EDID_BYTES_LEN, edid_file);
-        fclose(edid_file);
-
-        if (*length <= 0) {
-            hal_err("Failed to read EDID from %s\n", edid_path);
-            closedir(drm_class);
-            return dsERR_GENERAL;
-        }
-
-        strncpy(connector_name, entry->d_name, sizeof(connector_name) - 1);
-        hal_dbg("Read %d bytes of EDID from %s(%s)\n", *length, edid_path, connector_name);
-        break;
-    }
-    closedir(drm_class);
-
-    if (*length == 0) {
+    if (!dsEdidCacheGet(edid, length, NULL)) {
         hal_err("EDID not found for connected HDMI0 connector\n");
+        *length = 0;
         return dsERR_GENERAL;
     }
 
@@ -1213,7 +1543,7 @@ dsError_t dsGetEDIDBytes(intptr_t handle, unsigned char *edid, int *length)
             fprintf(file, "%02x", edid[i]);
         }
         fclose(file);
-        hal_info("EDID bytes written to /tmp/.hal-edid-bytes.dat (%d bytes from %s)\n", *length, connector_name);
+        hal_info("EDID bytes written to /tmp/.hal-edid-bytes.dat (%d bytes)\n", *length);
     } else {
         hal_err("Failed to open /tmp/.hal-edid-bytes.dat\n");
     }
@@ -0,0 +1,88 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DSDISPLAYEVENTSUBSCRIBER_H
+#define __DSDISPLAYEVENTSUBSCRIBER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsDisplay.h"
+#include "dsError.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of concurrent subscribers, internal modules included. */
+#define dsDISPLAY_EVENT_MAX_SUBSCRIBERS 8
+
+/**
+ * @brief HDMI connector-state event delivered to subscribers.
+ */
+typedef struct _dsDisplayEventInfo_t {
+    dsDisplayEvent_t event;             /* dsDISPLAY_EVENT_CONNECTED or dsDISPLAY_EVENT_DISCONNECTED */
+    bool connected;                     /* HDMI connection state after the event */
+    bool stateChanged;                  /* False when a connected display re-announces itself (EDID change) */
+} dsDisplayEventInfo_t;
+
+/**
+ * @brief Subscriber callback. Runs on the HAL event dispatcher thread; it must not block.
+ */
+typedef void (*dsDisplayEventSubscriber_t)(const dsDisplayEventInfo_t *info, void *userData);
+
+/**
+ * @brief Subscribes to HDMI connector-state events.
+ *
+ * Each event is delivered once to every subscriber, in subscription order. Unlike
+ * dsRegisterDisplayEventCallback(), any number of clients (up to
+ * dsDISPLAY_EVENT_MAX_SUBSCRIBERS) can subscribe, and subscribing does not require
+ * dsDisplayInit(); events flow while the display module is initialised.
+ *
+ * @param[in]  subscriber  - Callback to invoke
+ * @param[in]  userData    - Opaque pointer passed back to the callback
+ * @param[out] token       - Non-zero token for dsDisplayEventUnsubscribe()
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Success
+ * @retval dsERR_INVALID_PARAM            -  Parameter passed to this function is invalid
+ * @retval dsERR_RESOURCE_NOT_AVAILABLE   -  All subscriber slots are in use
+ */
+dsError_t dsDisplayEventSubscribe(dsDisplayEventSubscriber_t subscriber, void *userData, uint32_t *token);
+
+/**
+ * @brief Removes a subscription.
+ *
+ * When called from another thread, it returns only after any callback invocation in
+ * progress has finished, so userData can be freed afterwards. It may also be called
+ * from inside a subscriber callback.
+ *
+ * @param[in] token  - Token returned by dsDisplayEventSubscribe()
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Success
+ * @retval dsERR_INVALID_PARAM            -  Token is not subscribed
+ */
+dsError_t dsDisplayEventUnsubscribe(uint32_t token);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
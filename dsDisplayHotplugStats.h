@@ -0,0 +1,66 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DSDISPLAYHOTPLUGSTATS_H
+#define __DSDISPLAYHOTPLUGSTATS_H
+
+#include <stdint.h>
+
+#include "dsError.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief HDMI hotplug counters since dsDisplayInit().
+ *
+ * The watcher debounces connection edges over a settle window (DSHAL_HDMI_DEBOUNCE_MS,
+ * 300 ms by default). Edges that revert or are overtaken within the window are
+ * suppressed; a high suppressed count points at a flaky cable or sink handshake.
+ * Settled changes are delivered to callbacks from a dispatcher thread through a
+ * bounded queue; if callbacks fall behind, queued events collapse to the latest state.
+ */
+typedef struct _dsHdmiHotplugStats_t {
+    uint64_t hotplugEvents;             /* udev HOTPLUG=1 events received */
+    uint64_t transitionsObserved;       /* Connection changes seen when reading DRM */
+    uint64_t transitionsDelivered;      /* Settled changes reported to callbacks */
+    uint64_t transitionsSuppressed;     /* Observed changes that were never reported */
+    uint64_t eventsCollapsed;           /* Events folded into the latest state on queue overflow */
+} dsHdmiHotplugStats_t;
+
+/**
+ * @brief Gets the HDMI hotplug debounce counters.
+ *
+ * @param[out] stats  - Counters since dsDisplayInit()
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Success
+ * @retval dsERR_NOT_INITIALIZED          -  Module is not initialised
+ * @retval dsERR_INVALID_PARAM            -  Parameter passed to this function is invalid
+ *
+ * @pre  dsDisplayInit() should be called before calling this API.
+ */
+dsError_t dsGetHdmiHotplugStats(dsHdmiHotplugStats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,15 +24,16 @@
 #include <unistd.h>
 #include <string.h>
 #include <pthread.h>
+#include <time.h>
 #include <dirent.h>
 #include <errno.h>
 #include <limits.h>
-#include <threads.h>
 
 #include "dsUtl.h"
 #include "dsError.h"
 #include "dsTypes.h"
 #include "dsVideoPort.h"
+#include "dsVideoPortAsync.h"
 #include "dsVideoResolutionSettings.h"
 #include "dsDisplay.h"
 #include "dsAudio.h"
@@ -48,10 +49,34 @@ extern dsRegisterFrameratePreChangeCB_t dsVideoDeviceGetFrameratePreChangeCB(voi
 extern dsRegisterFrameratePostChangeCB_t dsVideoDeviceGetFrameratePostChangeCB(void);
 
 static bool _bIsVideoPortInitialized = false;
+static bool _bDrmContextHeld = false;
+/* Serialises mode switches between dsSetResolution() and the async worker. */
+static pthread_mutex_t gModeSwitchMutex = PTHREAD_MUTEX_INITIALIZER;
 static bool isValidVopHandle(intptr_t handle);
 static const char *dsVideoGetResolution(void);
+static const char *dsVideoResolutionFromModeReply(const char *respBuf);
 
 #define MAX_HDMI_MODE_ID (127)
+/* Deadline for a mode switch to show up on the CRTC after westeros accepted it. */
+#define DSVIDEOPORT_MODESET_TIMEOUT_MS 1000
+
+/*
+ * Backend applying HDMI mode switches. Westeros is the default; building with
+ * ENABLE_DRM_ATOMIC_MODESET makes DRM atomic the default, and DSHAL_MODESET_BACKEND
+ * (westeros|drm) overrides either at dsVideoPortInit().
+ */
+typedef enum {
+    DS_MODESET_BACKEND_WESTEROS = 0,
+    DS_MODESET_BACKEND_DRM_ATOMIC,
+} dsModesetBackend_t;
+
+#ifdef DSHAL_DRM_ATOMIC_MODESET_DEFAULT
+#define DSVIDEOPORT_MODESET_BACKEND_DEFAULT DS_MODESET_BACKEND_DRM_ATOMIC
+#else
+#define DSVIDEOPORT_MODESET_BACKEND_DEFAULT DS_MODESET_BACKEND_WESTEROS
+#endif
+
+static dsModesetBackend_t _modesetBackend = DSVIDEOPORT_MODESET_BACKEND_DEFAULT;
 
 #ifndef XDG_RUNTIME_DIR
 #define XDG_RUNTIME_DIR     "/tmp"
@@ -71,214 +96,52 @@ static VOPHandle_t _vopHandles[dsVIDEOPORT_TYPE_MAX][2] = {};
 static dsVideoPortResolution_t _resolution;
 static bool _bIgnoreEDID = false;
 
-static bool drm_get_hdmi_connector_state(bool *connected, bool *enabled)
-{
-    return dsGetHdmiConnectorState(connected, enabled);
-}
-
-static void resolveResolutionToken(const char *token, char *out, size_t outSize)
+static dsModesetBackend_t dsModesetBackendFromEnv(void)
 {
-    if (out == NULL || outSize == 0) {
-        return;
-    }
-
-    out[0] = '\0';
-    if (token == NULL || token[0] == '\0') {
-        return;
-    }
-
-    char trimmedToken[64] = {'\0'};
-    strncpy(trimmedToken, token, sizeof(trimmedToken) - 1);
-    trimmedToken[sizeof(trimmedToken) - 1] = '\0';
-
-    size_t len = strlen(trimmedToken);
-    while (len > 0 && isspace((unsigned char)trimmedToken[len - 1])) {
-        trimmedToken[--len] = '\0';
-    }
+    const char *value = getenv("DSHAL_MODESET_BACKEND");
 
-    if (len == 0) {
-        return;
+    if (value == NULL || value[0] == '\0') {
+        return DSVIDEOPORT_MODESET_BACKEND_DEFAULT;
     }
-
-    char normalizedToken[64] = {'\0'};
-    int width = -1;
-    int height = -1;
-    int rate = -1;
-    char scanMode = '\0';
-
-    if (sscanf(trimmedToken, "%dx%d%c%d", &width, &height, &scanMode, &rate) == 4) {
-        scanMode = (char)tolower((unsigned char)scanMode);
-        if (width > 0 && height > 0 && rate > 0 && (scanMode == 'p' || scanMode == 'i')) {
-            (void)snprintf(normalizedToken, sizeof(normalizedToken), "%d%c%d", height, scanMode, rate);
-        }
+    if (strcmp(value, "drm") == 0) {
+        return DS_MODESET_BACKEND_DRM_ATOMIC;
     }
-
-    const char *candidate = (normalizedToken[0] != '\0') ? normalizedToken : trimmedToken;
-    for (size_t i = 0; i < noOfItemsInResolutionMap; i++) {
-        const char *mapRes = resolutionMap[i].rdkRes;
-        size_t mapLen = strlen(mapRes);
-        bool mapHasRate = (mapLen > 0 && isdigit((unsigned char)mapRes[mapLen - 1]));
-
-        if (mapHasRate) {
-            if (strcmp(mapRes, candidate) == 0) {
-                strncpy(out, mapRes, outSize - 1);
-                out[outSize - 1] = '\0';
-                return;
-            }
-        } else {
-            char mapResWithDefaultRate[64] = {'\0'};
-            (void)snprintf(mapResWithDefaultRate, sizeof(mapResWithDefaultRate), "%s60", mapRes);
-            if (strcmp(mapRes, candidate) == 0 || strcmp(mapResWithDefaultRate, candidate) == 0) {
-                strncpy(out, mapRes, outSize - 1);
-                out[outSize - 1] = '\0';
-                return;
-            }
-        }
+    if (strcmp(value, "westeros") == 0) {
+        return DS_MODESET_BACKEND_WESTEROS;
     }
-
-    strncpy(out, candidate, outSize - 1);
-    out[outSize - 1] = '\0';
+    hal_warn("Ignoring invalid DSHAL_MODESET_BACKEND=%s\n", value);
+    return DSVIDEOPORT_MODESET_BACKEND_DEFAULT;
 }
 
-static bool resolutionNamesEquivalent(const char *requested, const char *active)
-{
-    char requestedCanonical[64] = {'\0'};
-    char activeCanonical[64] = {'\0'};
-
-    resolveResolutionToken(requested, requestedCanonical, sizeof(requestedCanonical));
-    resolveResolutionToken(active, activeCanonical, sizeof(activeCanonical));
-
-    return (requestedCanonical[0] != '\0' && activeCanonical[0] != '\0' &&
-            strcmp(requestedCanonical, activeCanonical) == 0);
-}
-
-static dsError_t getHdmiEdidForConnectedDisplay(dsVideoPortType_t video_port_type,
-        int video_port_index,
-        unsigned char **edid_buf,
-        int *edid_len)
-{
-    intptr_t dispHandle = 0;
-
-    if (edid_buf == NULL || edid_len == NULL) {
-        return dsERR_INVALID_PARAM;
-    }
-
-    *edid_buf = (unsigned char *)calloc(MAX_EDID_BYTES_LEN, sizeof(unsigned char));
-    if (*edid_buf == NULL) {
-        return dsERR_GENERAL;
-    }
-
-    if (dsGetDisplay(video_port_type, video_port_index, &dispHandle) != dsERR_NONE ||
-            dsGetEDIDBytes(dispHandle, *edid_buf, edid_len) != dsERR_NONE ||
-            *edid_len < DSHAL_EDID_BLOCK_SIZE) {
-        free(*edid_buf);
-        *edid_buf = NULL;
-        *edid_len = 0;
-        return dsERR_GENERAL;
-    }
-
-    return dsERR_NONE;
-}
-
-typedef struct {
-    int *capabilities;
-} HdrParseContext_t;
-
-static bool parseHdrFromCtaDataBlock(int tag, const unsigned char *data, int dataLen, void *context)
+static bool drm_get_hdmi_connector_state(bool *connected, bool *enabled)
 {
-    HdrParseContext_t *ctx = (HdrParseContext_t *)context;
-
-    if (ctx == NULL || ctx->capabilities == NULL || data == NULL) {
-        return false;
-    }
-
-    if (tag == DSHAL_EDID_CTA_EXTENDED_TAG && dataLen >= 2 &&
-            data[0] == DSHAL_EDID_EXT_TAG_HDR_STATIC_METADATA) {
-        unsigned char eotf_flags = data[1];
-        if (eotf_flags & 0x01) {
-            *(ctx->capabilities) |= (int)dsHDRSTANDARD_SDR;
-        }
-        if (eotf_flags & 0x02) {
-            *(ctx->capabilities) |= (int)dsHDRSTANDARD_TechnicolorPrime;
-        }
-        if (eotf_flags & DSHAL_EDID_EOTF_HDR10_BIT) {
-            *(ctx->capabilities) |= (int)dsHDRSTANDARD_HDR10;
-        }
-        if (eotf_flags & DSHAL_EDID_EOTF_HLG_BIT) {
-            *(ctx->capabilities) |= (int)dsHDRSTANDARD_HLG;
-        }
-    } else if (tag == DSHAL_EDID_CTA_VENDOR_SPECIFIC_TAG && dataLen >= 3) {
-        if (data[0] == DSHAL_EDID_DOLBY_VSIF_OUI_BYTE0 &&
-                data[1] == DSHAL_EDID_DOLBY_VSIF_OUI_BYTE1 &&
-                data[2] == DSHAL_EDID_DOLBY_VSIF_OUI_BYTE2) {
-            *(ctx->capabilities) |= (int)dsHDRSTANDARD_DolbyVision;
-        }
-
-        if (data[0] == DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE0 &&
-                data[1] == DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE1 &&
-                data[2] == DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE2) {
-            *(ctx->capabilities) |= (int)dsHDRSTANDARD_HDR10PLUS;
-        }
-    }
-
-    return false;
+    return dsGetHdmiConnectorStateCached(connected, enabled);
 }
 
-typedef struct {
-    int *resolutions;
-} TvResolutionParseContext_t;
-
-static bool parseSupportedResolutionsFromCtaDataBlock(int tag, const unsigned char *data, int dataLen, void *context)
+/* Same mode by canonical key (height, scan, rate); names that do not parse must match exactly. */
+static bool resolutionNamesEquivalent(const char *requested, const char *active)
 {
-    TvResolutionParseContext_t *ctx = (TvResolutionParseContext_t *)context;
-
-    if (ctx == NULL || ctx->resolutions == NULL || data == NULL) {
-        return false;
-    }
+    dsResolutionKey_t requestedKey;
+    dsResolutionKey_t activeKey;
 
-    if (tag != DSHAL_EDID_CTA_DATA_BLOCK_TAG_VIDEO || dataLen <= 0) {
+    if (requested == NULL || active == NULL) {
         return false;
     }
-
-    for (int i = 0; i < dataLen; i++) {
-        int vic = data[i] & 0x7F;
-        const dsTVResolution_t *tvRes = getResolutionFromVic(vic);
-        if (tvRes != NULL) {
-            *(ctx->resolutions) |= (int)(*tvRes);
-        }
+    if (dsResolutionKeyFromName(requested, &requestedKey) && dsResolutionKeyFromName(active, &activeKey)) {
+        return requestedKey == activeKey;
     }
-
-    return false;
+    return strcmp(requested, active) == 0;
 }
 
-typedef struct {
-    bool *surround;
-} SurroundParseContext_t;
-
-static bool parseSurroundFromCtaDataBlock(int tag, const unsigned char *data, int dataLen, void *context)
+/* EDID capabilities of the connected display, analysed once per EDID and cached in dshalUtils. */
+static dsError_t getHdmiCapabilitiesForConnectedDisplay(dshalEdidCapabilities_t *caps)
 {
-    SurroundParseContext_t *ctx = (SurroundParseContext_t *)context;
-
-    if (ctx == NULL || ctx->surround == NULL || data == NULL) {
-        return false;
-    }
-
-    if (tag != DSHAL_EDID_CTA_DATA_BLOCK_TAG_AUDIO || dataLen < DSHAL_EDID_CTA_SHORT_AUDIO_DESCRIPTOR_LEN) {
-        return false;
-    }
-
-    for (int i = 0; (i + (DSHAL_EDID_CTA_SHORT_AUDIO_DESCRIPTOR_LEN - 1)) < dataLen; i += DSHAL_EDID_CTA_SHORT_AUDIO_DESCRIPTOR_LEN) {
-        int channels = (data[i] & 0x07) + 1;
-        if (channels > 2) {
-            *(ctx->surround) = true;
-            return true;
-        }
+    if (caps == NULL) {
+        return dsERR_INVALID_PARAM;
     }
-
-    return false;
+    return dsEdidCacheGetCapabilities(caps) ? dsERR_NONE : dsERR_GENERAL;
 }
 
-
 /**
  * @brief Register for a callback routine for HDCP Auth
  *
@@ -346,6 +209,14 @@ dsError_t  dsVideoPortInit()
     hal_info("&_vopHandles[dsVIDEOPORT_TYPE_HDMI][0].m_isEnabled = %p\n", &_vopHandles[dsVIDEOPORT_TYPE_HDMI][0].m_isEnabled);
     _resolution = kResolutionsSettings[kDefaultResIndex];
 
+    _bDrmContextHeld = dsDrmContextAcquire();
+    if (!_bDrmContextHeld) {
+        hal_warn("Shared DRM context unavailable, DRM queries will open the card per call\n");
+    }
+    _modesetBackend = dsModesetBackendFromEnv();
+    dsResolutionIndexInit();
+    hal_info("HDMI modeset backend: %s\n", (_modesetBackend == DS_MODESET_BACKEND_DRM_ATOMIC) ? "drm" : "westeros");
+
     /* HDCP callback registration removed: tvservice eliminated, HDCP status assumed authenticated by default */
     _bIsVideoPortInitialized = true;
 
@@ -842,76 +713,268 @@ dsError_t dsGetResolution(intptr_t handle, dsVideoPortResolution_t *resolution)
 static const char* dsVideoGetResolution(void)
 {
     hal_info("invoked.\n");
-    char resName[32] = {'\0'};
-    char normalizedRes[32] = {'\0'};
-    const char *resolution_name = NULL;
     char respBuf[256] = {'\0'};
-    if (westerosGLConsoleRWWrapper("get mode", respBuf, sizeof(respBuf))) {
-        strncpy(resName, respBuf, sizeof(resName) - 1);
-        resName[sizeof(resName) - 1] = '\0';
-
-        int modeStatus = -1;
-        char modeToken[32] = {'\0'};
-        if (sscanf(resName, "%d: mode %31s", &modeStatus, modeToken) == 2 && modeStatus == 0) {
-            strncpy(resName, modeToken, sizeof(resName) - 1);
-            resName[sizeof(resName) - 1] = '\0';
-        }
-    } else {
+    if (!westerosGLConsoleRWWrapper("get mode", respBuf, sizeof(respBuf))) {
         hal_err("Failed to get current mode, got response '%s'\n", respBuf);
         return NULL;
     }
+    return dsVideoResolutionFromModeReply(respBuf);
+}
+
+/* Maps a westeros "get mode" reply to the matching RDK resolution token, or NULL. */
+static const char* dsVideoResolutionFromModeReply(const char *respBuf)
+{
+    char resName[32] = {'\0'};
+    const char *resolution_name = NULL;
+
+    strncpy(resName, respBuf, sizeof(resName) - 1);
+    resName[sizeof(resName) - 1] = '\0';
+
+    int modeStatus = -1;
+    char modeToken[32] = {'\0'};
+    if (sscanf(resName, "%d: mode %31s", &modeStatus, modeToken) == 2 && modeStatus == 0) {
+        strncpy(resName, modeToken, sizeof(resName) - 1);
+        resName[sizeof(resName) - 1] = '\0';
+    }
 
     size_t resLen = strlen(resName);
     while (resLen > 0 && isspace((unsigned char)resName[resLen - 1])) {
         resName[--resLen] = '\0';
     }
 
-    int width = -1;
-    int height = -1;
-    int rate = -1;
-    char scanMode = '\0';
-    if (sscanf(resName, "%dx%d%c%d", &width, &height, &scanMode, &rate) == 4) {
-        scanMode = (char)tolower((unsigned char)scanMode);
-        if (width > 0 && height > 0 && rate > 0 && (scanMode == 'p' || scanMode == 'i')) {
-            snprintf(normalizedRes, sizeof(normalizedRes), "%d%c%d", height, scanMode, rate);
-        }
+    dsResolutionKey_t key;
+    if (dsResolutionKeyFromName(resName, &key)) {
+        resolution_name = dsResolutionMapNameByKey(key);
     }
-
-    if (normalizedRes[0] == '\0') {
-        strncpy(normalizedRes, resName, sizeof(normalizedRes) - 1);
-        normalizedRes[sizeof(normalizedRes) - 1] = '\0';
+    if (resolution_name != NULL) {
+        hal_info("resolution_name %s\n", resolution_name);
+    } else {
+        hal_err("Failed to find matching resolution for mode '%s'\n", resName);
     }
 
-    hal_info("resName '%s', normalized '%s'\n", resName, normalizedRes);
+    return resolution_name;
+}
 
-    for (size_t i = 0; i < noOfItemsInResolutionMap; i++) {
-        const char *mapRes = resolutionMap[i].rdkRes;
+static bool isValidResolutionRequest(intptr_t handle, const dsVideoPortResolution_t *resolution)
+{
+    return isValidVopHandle(handle) && NULL != resolution && resolution->name[0] != '\0' &&
+        dsVideoPortPixelResolution_isValid(resolution->pixelResolution) &&
+        dsVideoPortAspectRatio_isValid(resolution->aspectRatio) &&
+        dsVideoPortStereoScopicMode_isValid(resolution->stereoScopicMode) &&
+        dsVideoPortFrameRate_isValid(resolution->frameRate) &&
+        dsVideoPortScanMode_isValid((int)resolution->interlaced);
+}
 
-        size_t len = strlen(mapRes);
-        int hasRate = (len > 0 && isdigit((unsigned char)mapRes[len-1]));
+/*
+ * Sends the mode to westeros and verifies it took effect. *modeMatched and *activeRes
+ * (RDK name, or NULL when unknown) describe the mode found active afterwards.
+ */
+static dsError_t dsSetHdmiModeWesteros(const char *name, int width, int height, char interlaced, int rate,
+        bool *modeMatched, const char **activeRes)
+{
+    char cmdBuf[256] = {'\0'};
+    char respBuf[256] = {'\0'};
 
-        if (hasRate) {
-            if (strcmp(mapRes, normalizedRes) == 0) {
-                resolution_name = mapRes;
-                break;
-            }
+    //extended command to make resolution setting more synchronous
+    int snprintfResult = snprintf(cmdBuf, sizeof(cmdBuf), "set mode %dx%d%c%d", width, height, interlaced, rate);
+    if (snprintfResult < 0 || snprintfResult >= (int)sizeof(cmdBuf)) {
+        hal_err("Command buffer too small or snprintf error\n");
+        return dsERR_GENERAL;
+    }
+    /* Pipeline the first verification read behind the mode set; one round trip when the switch is immediate. */
+    char modeBuf[256] = {'\0'};
+    dsWesterosCommand_t cmds[] = {
+        { .cmd = cmdBuf, .resp = respBuf, .respSize = sizeof(respBuf) },
+        { .cmd = "get mode", .resp = modeBuf, .respSize = sizeof(modeBuf) },
+    };
+    if (!westerosGLConsoleRWBatch(cmds, sizeof(cmds) / sizeof(cmds[0]))) {
+        hal_err("Failed to run '%s', got response '%s'\n", cmdBuf, respBuf);
+        return dsERR_GENERAL;
+    }
+    int cmdStatus = -1;
+    bool isStatusPrefixedSuccess = (sscanf(respBuf, "%d:", &cmdStatus) == 1 && cmdStatus == 0);
+    if (strcmp(respBuf, "OK") != 0 && !isStatusPrefixedSuccess) {
+        hal_err("Failed to set resolution with command '%s', got response '%s'\n", cmdBuf, respBuf);
+        return dsERR_GENERAL;
+    }
+    /*
+     * Verify the mode actually took effect; mode switch can be asynchronous. The
+     * pipelined reply covers an immediate switch, otherwise wait for DRM to show
+     * the new mode on the CRTC.
+     */
+    *activeRes = dsVideoResolutionFromModeReply(modeBuf);
+    *modeMatched = (*activeRes != NULL && resolutionNamesEquivalent(name, *activeRes));
+    if (*modeMatched) {
+        /* A modeset raises no hotplug, so republish the snapshot with the new CRTC mode. */
+        bool drmConnected = false;
+        bool drmEnabled = false;
+        (void)dsGetHdmiConnectorState(&drmConnected, &drmEnabled);
+    } else {
+        int waitedMs = 0;
+        *modeMatched = dsWaitHdmiCrtcMode(width, height, interlaced == 'i', rate,
+                DSVIDEOPORT_MODESET_TIMEOUT_MS, &waitedMs);
+        if (*modeMatched) {
+            /* The pipelined reply predates the switch; report the requested mode instead. */
+            *activeRes = NULL;
+            hal_info("Mode %dx%d%c%d active on the CRTC after %d ms\n", width, height, interlaced, rate, waitedMs);
         } else {
-            char temp[32];
-            snprintf(temp,sizeof(temp), "%s60", mapRes);
+            /* DRM may be unavailable or report the mode differently; ask westeros once more. */
+            *activeRes = dsVideoGetResolution();
+            *modeMatched = (*activeRes != NULL && resolutionNamesEquivalent(name, *activeRes));
+        }
+    }
+
+    return dsERR_NONE;
+}
+
+/* Commits the mode with DRM atomic and waits for the CRTC to run it. */
+static dsError_t dsSetHdmiModeDrmAtomic(const char *name, int width, int height, char interlaced, int rate,
+        bool *modeMatched, const char **activeRes)
+{
+    int waitedMs = 0;
+    dsError_t ret = dsDrmAtomicSetHdmiMode(width, height, interlaced == 'i', rate, false);
+
+    *activeRes = NULL;
+    if (ret != dsERR_NONE) {
+        hal_err("DRM atomic commit of '%s' failed\n", name);
+        return dsERR_GENERAL;
+    }
+    /* The commit is blocking, so this normally matches on the first read. */
+    *modeMatched = dsWaitHdmiCrtcMode(width, height, interlaced == 'i', rate, DSVIDEOPORT_MODESET_TIMEOUT_MS, &waitedMs);
+    if (*modeMatched) {
+        hal_info("Mode %dx%d%c%d active on the CRTC after %d ms\n", width, height, interlaced, rate, waitedMs);
+    } else {
+        *activeRes = dsVideoGetResolution();
+    }
+    return dsERR_NONE;
+}
 
-            if (strcmp(temp, normalizedRes) == 0 || strcmp(mapRes, normalizedRes) == 0) {
-                resolution_name = mapRes;
-                break;
+/*
+ * Applies an HDMI resolution through the selected backend and waits until it is active,
+ * firing the framerate pre/post-change hooks around the switch. With the DRM backend the
+ * mode is validated first and a mode the display does not offer is rejected before the
+ * hooks fire; if atomic modesetting is not usable it falls back to westeros. On return
+ * activeMode (optional) holds the RDK name of the mode that is active. Callers hold
+ * gModeSwitchMutex.
+ */
+static dsError_t dsApplyHdmiResolution(const dsVideoPortResolution_t *resolution, char *activeMode, size_t activeModeSize)
+{
+    hal_dbg("Setting HDMI resolution '%s'\n", resolution->name);
+    if (activeMode != NULL && activeModeSize > 0) {
+        activeMode[0] = '\0';
+    }
+    int width = -1, height = -1;
+    int rate = 60;
+    char interlaced = 'n';
+    if (sscanf (resolution->name, "%dx%dp%d", &width, &height, &rate) == 3) {
+        interlaced = 'p';
+    }
+    else if (sscanf(resolution->name, "%dx%di%d", &width, &height, &rate ) == 3) {
+        interlaced = 'i';
+    }
+    else if (sscanf(resolution->name, "%dx%dx%d", &width, &height, &rate ) == 3) {
+        interlaced = 'p';
+    }
+    else if (sscanf(resolution->name, "%dx%d", &width, &height ) == 2) {
+        interlaced = 'p';
+    }
+    else if (sscanf(resolution->name, "%dp%d", &height, &rate ) == 2) {
+        interlaced = 'p';
+        width= -1;
+    }
+    else if (sscanf(resolution->name, "%di%d", &height, &rate ) == 2) {
+        interlaced = 'i';
+        width= -1;
+    }
+    else if (sscanf(resolution->name, "%d%c", &height, &interlaced ) == 2) {
+        width= -1;
+        rate = 60;
+    }
+
+    interlaced = (char)tolower((unsigned char)interlaced);
+
+    //if width is missing, set it manually
+    if (height > 0) {
+        if (width < 0) {
+            switch (height)
+            {
+                case 480:
+                case 576:
+                    width= 720;
+                    break;
+                case 720:
+                    width= 1280;
+                    break;
+                case 1080:
+                    width= 1920;
+                    break;
+                case 1440:
+                    width= 2560;
+                    break;
+                case 2160:
+                    width= 3840;
+                    break;
+                case 2880:
+                    width= 5120;
+                    break;
+                case 4320:
+                    width= 7680;
+                    break;
+                default:
+                    break;
             }
         }
     }
-    if (resolution_name != NULL) {
-        hal_info("resolution_name %s\n", resolution_name);
-    } else {
-        hal_err("Failed to find matching resolution for mode '%s' (normalized '%s')\n", resName, normalizedRes);
+
+    if (width <= 0 || height <= 0 || rate <= 0 || (interlaced != 'p' && interlaced != 'i')) {
+        hal_err("Unsupported resolution format '%s' parsed as %dx%d%c%d\n",
+                resolution->name, width, height, interlaced, rate);
+        return dsERR_INVALID_PARAM;
     }
 
-    return resolution_name;
+    bool useDrm = (_modesetBackend == DS_MODESET_BACKEND_DRM_ATOMIC);
+    if (useDrm) {
+        /* Validate before the framerate hooks fire so an unsupported mode costs no switch. */
+        dsError_t testRet = dsDrmAtomicSetHdmiMode(width, height, interlaced == 'i', rate, true);
+        if (testRet == dsERR_INVALID_PARAM) {
+            hal_err("Mode %dx%d%c%d rejected by DRM validation\n", width, height, interlaced, rate);
+            return dsERR_INVALID_PARAM;
+        }
+        if (testRet != dsERR_NONE) {
+            hal_warn("DRM atomic modeset unavailable (%d), using westeros\n", testRet);
+            useDrm = false;
+        }
+    }
+
+    dsRegisterFrameratePreChangeCB_t frameratePreCB = dsVideoDeviceGetFrameratePreChangeCB();
+    if (frameratePreCB) {
+        frameratePreCB((unsigned int)rate);
+    }
+    const char *activeRes = NULL;
+    bool modeMatched = false;
+    dsError_t ret = useDrm ?
+        dsSetHdmiModeDrmAtomic(resolution->name, width, height, interlaced, rate, &modeMatched, &activeRes) :
+        dsSetHdmiModeWesteros(resolution->name, width, height, interlaced, rate, &modeMatched, &activeRes);
+    if (ret != dsERR_NONE) {
+        return ret;
+    }
+
+    if (activeMode != NULL && activeModeSize > 0) {
+        /* A DRM confirmation means the requested mode is the active one. */
+        const char *reported = modeMatched ? (activeRes ? activeRes : resolution->name) : activeRes;
+        snprintf(activeMode, activeModeSize, "%s", reported ? reported : "");
+    }
+    if (!modeMatched) {
+        hal_err("Resolution mismatch after set: requested '%s', active '%s'\n",
+                resolution->name, activeRes ? activeRes : "<unknown>");
+        return dsERR_GENERAL;
+    }
+
+    dsRegisterFrameratePostChangeCB_t frameratePostCB = dsVideoDeviceGetFrameratePostChangeCB();
+    if (frameratePostCB) {
+        frameratePostCB((unsigned int)rate);
+    }
+    return dsERR_NONE;
 }
 
 /**
@@ -949,138 +1012,197 @@ dsError_t dsSetResolution(intptr_t handle, dsVideoPortResolution_t *resolution)
     if (false == _bIsVideoPortInitialized) {
         return dsERR_NOT_INITIALIZED;
     }
-    if (!isValidVopHandle(handle) || NULL == resolution || resolution->name[0] == '\0' ||
-        !dsVideoPortPixelResolution_isValid(resolution->pixelResolution) ||
-        !dsVideoPortAspectRatio_isValid(resolution->aspectRatio) ||
-        !dsVideoPortStereoScopicMode_isValid(resolution->stereoScopicMode) ||
-        !dsVideoPortFrameRate_isValid(resolution->frameRate) ||
-        !dsVideoPortScanMode_isValid((int)resolution->interlaced)) {
+    if (!isValidResolutionRequest(handle, resolution)) {
         hal_err("dsSetResolution dsERR_INVALID_PARAM - Invalid handle or resolution parameters\n");
         return dsERR_INVALID_PARAM;
     }
     if (vopHandle->m_vType == dsVIDEOPORT_TYPE_HDMI) {
-        hal_dbg("Setting HDMI resolution '%s'\n", resolution->name);
-        char cmdBuf[256] = {'\0'};
-        char respBuf[256] = {'\0'};
-        int width = -1, height = -1;
-        int rate = 60;
-        char interlaced = 'n';
-        if (sscanf (resolution->name, "%dx%dp%d", &width, &height, &rate) == 3) {
-            interlaced = 'p';
-        }
-        else if (sscanf(resolution->name, "%dx%di%d", &width, &height, &rate ) == 3) {
-            interlaced = 'i';
-        }
-        else if (sscanf(resolution->name, "%dx%dx%d", &width, &height, &rate ) == 3) {
-            interlaced = 'p';
-        }
-        else if (sscanf(resolution->name, "%dx%d", &width, &height ) == 2) {
-            interlaced = 'p';
-        }
-        else if (sscanf(resolution->name, "%dp%d", &height, &rate ) == 2) {
-            interlaced = 'p';
-            width= -1;
-        }
-        else if (sscanf(resolution->name, "%di%d", &height, &rate ) == 2) {
-            interlaced = 'i';
-            width= -1;
-        }
-        else if (sscanf(resolution->name, "%d%c", &height, &interlaced ) == 2) {
-            width= -1;
-            rate = 60;
-        }
+        dsError_t ret;
+        pthread_mutex_lock(&gModeSwitchMutex);
+        ret = dsApplyHdmiResolution(resolution, NULL, 0);
+        pthread_mutex_unlock(&gModeSwitchMutex);
+        return ret;
+    } else {
+        hal_err("Unsupported video port type: %d\n", vopHandle->m_vType);
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    return dsERR_NONE;
+}
 
-        interlaced = (char)tolower((unsigned char)interlaced);
-
-        //if width is missing, set it manually
-        if (height > 0) {
-            if (width < 0) {
-                switch (height)
-                {
-                    case 480:
-                    case 576:
-                        width= 720;
-                        break;
-                    case 720:
-                        width= 1280;
-                        break;
-                    case 1080:
-                        width= 1920;
-                        break;
-                    case 1440:
-                        width= 2560;
-                        break;
-                    case 2160:
-                        width= 3840;
-                        break;
-                    case 2880:
-                        width= 5120;
-                        break;
-                    case 4320:
-                        width= 7680;
-                        break;
-                    default:
-                        break;
-                }
-            }
-        }
+/*
+ * Asynchronous resolution changes. One worker thread, started on first use, applies
+ * requests through dsApplyHdmiResolution(). There is a single pending slot: a new
+ * request replaces a pending one, whose callback then reports it as superseded.
+ */
+typedef struct {
+    uint32_t id;
+    intptr_t handle;
+    dsVideoPortResolution_t resolution;
+    dsResolutionSwitchCB_t cb;
+    void *userData;
+} dsResolutionRequest_t;
 
-        if (width <= 0 || height <= 0 || rate <= 0 || (interlaced != 'p' && interlaced != 'i')) {
-            hal_err("Unsupported resolution format '%s' parsed as %dx%d%c%d\n",
-                    resolution->name, width, height, interlaced, rate);
-            return dsERR_INVALID_PARAM;
-        }
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    bool stop;
+    bool pending;
+    dsResolutionRequest_t request;
+    uint32_t nextId;
+} dsResolutionWorker_t;
+
+static dsResolutionWorker_t gResolutionWorker = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .running = false,
+    .stop = false,
+    .pending = false,
+    .nextId = 1,
+};
+
+static void dsResolutionRequestComplete(const dsResolutionRequest_t *request, dsError_t status,
+        bool superseded, const char *activeMode, unsigned int switchTimeMs)
+{
+    dsResolutionSwitchResult_t result;
 
-        //extended command to make resolution setting more synchronous
-        int snprintfResult = snprintf(cmdBuf, sizeof(cmdBuf), "set mode %dx%d%c%d", width, height, interlaced, rate);
-        if (snprintfResult < 0 || snprintfResult >= (int)sizeof(cmdBuf)) {
-            hal_err("Command buffer too small or snprintf error\n");
-            return dsERR_GENERAL;
-        }
-        dsRegisterFrameratePreChangeCB_t frameratePreCB = dsVideoDeviceGetFrameratePreChangeCB();
-        if (frameratePreCB) {
-            frameratePreCB((unsigned int)rate);
-        }
-        if (!westerosGLConsoleRWWrapper(cmdBuf, respBuf, sizeof(respBuf))) {
-            hal_err("Failed to run '%s', got response '%s'\n", cmdBuf, respBuf);
-            return dsERR_GENERAL;
-        }
-        int cmdStatus = -1;
-        bool isStatusPrefixedSuccess = (sscanf(respBuf, "%d:", &cmdStatus) == 1 && cmdStatus == 0);
-        if (strcmp(respBuf, "OK") != 0 && !isStatusPrefixedSuccess) {
-            hal_err("Failed to set resolution with command '%s', got response '%s'\n", cmdBuf, respBuf);
-            return dsERR_GENERAL;
-        }
-        /* Verify the mode actually took effect; mode switch can be asynchronous. */
-        const char *activeRes = NULL;
-        bool modeMatched = false;
-        const int verifyAttempts = 20;
-        const struct timespec verifySleep = { .tv_sec = 0, .tv_nsec = 50000000L }; /* 50 ms */
-
-        for (int attempt = 0; attempt < verifyAttempts; attempt++) {
-            activeRes = dsVideoGetResolution();
-            if (activeRes != NULL && resolutionNamesEquivalent(resolution->name, activeRes)) {
-                modeMatched = true;
-                break;
-            }
-            if (attempt < (verifyAttempts - 1)) {
-                thrd_sleep(&verifySleep, NULL);
-            }
-        }
+    if (request->cb == NULL) {
+        return;
+    }
+    memset(&result, 0, sizeof(result));
+    result.requestId = request->id;
+    result.status = status;
+    result.superseded = superseded;
+    result.switchTimeMs = switchTimeMs;
+    snprintf(result.activeMode, sizeof(result.activeMode), "%s", activeMode ? activeMode : "");
+    request->cb(request->handle, &result, request->userData);
+}
 
-        if (!modeMatched) {
-            hal_err("Resolution mismatch after set: requested '%s', active '%s'\n",
-                    resolution->name, activeRes ? activeRes : "<unknown>");
-            return dsERR_GENERAL;
+static void *dsResolutionWorkerThread(void *arg)
+{
+    dsResolutionWorker_t *worker = (dsResolutionWorker_t *)arg;
+
+    pthread_mutex_lock(&worker->lock);
+    for (;;) {
+        while (!worker->stop && !worker->pending) {
+            pthread_cond_wait(&worker->cond, &worker->lock);
         }
-        dsRegisterFrameratePostChangeCB_t frameratePostCB = dsVideoDeviceGetFrameratePostChangeCB();
-        if (frameratePostCB) {
-            frameratePostCB((unsigned int)rate);
+        if (worker->stop) {
+            break;
         }
-    } else {
+        dsResolutionRequest_t request = worker->request;
+        worker->pending = false;
+        pthread_mutex_unlock(&worker->lock);
+
+        char activeMode[sizeof(((dsResolutionSwitchResult_t *)0)->activeMode)];
+        struct timespec start, end;
+        /* Time the switch itself, not the wait for a synchronous switch to finish. */
+        pthread_mutex_lock(&gModeSwitchMutex);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        dsError_t status = dsApplyHdmiResolution(&request.resolution, activeMode, sizeof(activeMode));
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        pthread_mutex_unlock(&gModeSwitchMutex);
+
+        unsigned int switchTimeMs = (unsigned int)((end.tv_sec - start.tv_sec) * 1000L +
+                (end.tv_nsec - start.tv_nsec) / 1000000L);
+        hal_info("Async resolution request %u ('%s') finished with %d in %u ms\n",
+                request.id, request.resolution.name, status, switchTimeMs);
+        dsResolutionRequestComplete(&request, status, false, activeMode, switchTimeMs);
+
+        pthread_mutex_lock(&worker->lock);
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return NULL;
+}
+
+/* Stops the worker; a request still pending completes with dsERR_NOT_INITIALIZED. */
+static void dsResolutionWorkerStop(void)
+{
+    dsResolutionWorker_t *worker = &gResolutionWorker;
+    dsResolutionRequest_t dropped;
+    bool hadPending = false;
+
+    pthread_mutex_lock(&worker->lock);
+    if (!worker->running) {
+        pthread_mutex_unlock(&worker->lock);
+        return;
+    }
+    worker->stop = true;
+    if (worker->pending) {
+        dropped = worker->request;
+        worker->pending = false;
+        hadPending = true;
+    }
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+
+    pthread_join(worker->thread, NULL);
+
+    pthread_mutex_lock(&worker->lock);
+    worker->running = false;
+    worker->stop = false;
+    pthread_mutex_unlock(&worker->lock);
+
+    if (hadPending) {
+        dsResolutionRequestComplete(&dropped, dsERR_NOT_INITIALIZED, false, NULL, 0);
+    }
+}
+
+dsError_t dsSetResolutionAsync(intptr_t handle, const dsVideoPortResolution_t *resolution,
+        dsResolutionSwitchCB_t cb, void *userData, uint32_t *requestId)
+{
+    hal_info("invoked.\n");
+    dsResolutionWorker_t *worker = &gResolutionWorker;
+    VOPHandle_t *vopHandle = (VOPHandle_t *)handle;
+    dsResolutionRequest_t superseded;
+    bool hadPending = false;
+
+    if (false == _bIsVideoPortInitialized) {
+        return dsERR_NOT_INITIALIZED;
+    }
+    if (!isValidResolutionRequest(handle, resolution)) {
+        hal_err("dsSetResolutionAsync dsERR_INVALID_PARAM - Invalid handle or resolution parameters\n");
+        return dsERR_INVALID_PARAM;
+    }
+    if (vopHandle->m_vType != dsVIDEOPORT_TYPE_HDMI) {
         hal_err("Unsupported video port type: %d\n", vopHandle->m_vType);
         return dsERR_OPERATION_NOT_SUPPORTED;
     }
+
+    pthread_mutex_lock(&worker->lock);
+    if (!worker->running) {
+        worker->stop = false;
+        if (pthread_create(&worker->thread, NULL, dsResolutionWorkerThread, worker) != 0) {
+            pthread_mutex_unlock(&worker->lock);
+            hal_err("Failed to start the resolution worker thread\n");
+            return dsERR_RESOURCE_NOT_AVAILABLE;
+        }
+        worker->running = true;
+    }
+    if (worker->pending) {
+        superseded = worker->request;
+        hadPending = true;
+    }
+    worker->request.id = worker->nextId++;
+    if (worker->nextId == 0) {
+        worker->nextId = 1;
+    }
+    worker->request.handle = handle;
+    worker->request.resolution = *resolution;
+    worker->request.cb = cb;
+    worker->request.userData = userData;
+    worker->pending = true;
+    if (requestId != NULL) {
+        *requestId = worker->request.id;
+    }
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+
+    if (hadPending) {
+        hal_info("Async resolution request %u ('%s') superseded\n", superseded.id, superseded.resolution.name);
+        dsResolutionRequestComplete(&superseded, dsERR_OPERATION_FAILED, true, NULL, 0);
+    }
     return dsERR_NONE;
 }
 
@@ -1109,6 +1231,13 @@ dsError_t  dsVideoPortTerm()
     }
     /* HDCP callback unregistration removed: tvservice eliminated */
     _halhdcpcallback = NULL;
+    dsResolutionWorkerStop();
+    if (_bDrmContextHeld) {
+        dsDrmContextRelease();
+        _bDrmContextHeld = false;
+    }
+    /* The display socket connection is shared; any later command reconnects. */
+    westerosGLConsoleClose();
     _bIsVideoPortInitialized = false;
     return dsERR_NONE;
 }
@@ -1309,18 +1438,31 @@ dsError_t dsGetTVHDRCapabilities(intptr_t handle, int *capabilities)
 
     *capabilities = (int)dsHDRSTANDARD_SDR;
 
-    unsigned char *edid_buf = NULL;
-    int edid_len = 0;
+    dshalEdidCapabilities_t caps;
 
-    if (getHdmiEdidForConnectedDisplay(dsVIDEOPORT_TYPE_HDMI, 0, &edid_buf, &edid_len) != dsERR_NONE) {
+    if (getHdmiCapabilitiesForConnectedDisplay(&caps) != dsERR_NONE) {
         hal_warn("EDID unavailable; defaulting HDR capabilities to SDR\n");
         return dsERR_NONE;
     }
 
-    HdrParseContext_t ctx = { .capabilities = capabilities };
-    (void)dshalEdidForEachCtaDataBlock(edid_buf, edid_len, parseHdrFromCtaDataBlock, &ctx);
-
-    free(edid_buf);
+    if (caps.hdrEotfs & 0x01) {
+        *capabilities |= (int)dsHDRSTANDARD_SDR;
+    }
+    if (caps.hdrEotfs & 0x02) {
+        *capabilities |= (int)dsHDRSTANDARD_TechnicolorPrime;
+    }
+    if (caps.hdrEotfs & DSHAL_EDID_EOTF_HDR10_BIT) {
+        *capabilities |= (int)dsHDRSTANDARD_HDR10;
+    }
+    if (caps.hdrEotfs & DSHAL_EDID_EOTF_HLG_BIT) {
+        *capabilities |= (int)dsHDRSTANDARD_HLG;
+    }
+    if (caps.dolbyVision) {
+        *capabilities |= (int)dsHDRSTANDARD_DolbyVision;
+    }
+    if (caps.hdr10Plus) {
+        *capabilities |= (int)dsHDRSTANDARD_HDR10PLUS;
+    }
     hal_dbg("TV HDR capabilities from EDID: 0x%x\n", *capabilities);
     return dsERR_NONE;
 }
@@ -1375,19 +1517,20 @@ dsError_t dsSupportedTvResolutions(intptr_t handle, int *resolutions)
 
         /* Enumerate only the VICs advertised in the connected display's EDID
          * to avoid reporting unsupported modes from the static resolution map. */
-        unsigned char *edid_buf = NULL;
-        int edid_len = 0;
+        dshalEdidCapabilities_t caps;
 
-        if (getHdmiEdidForConnectedDisplay(dsVIDEOPORT_TYPE_HDMI, 0, &edid_buf, &edid_len) != dsERR_NONE) {
+        if (getHdmiCapabilitiesForConnectedDisplay(&caps) != dsERR_NONE) {
             hal_warn("EDID unavailable; cannot report supported TV resolutions\n");
             return dsERR_NONE;
         }
 
-        /* Walk CTA-861 extension blocks for Short Video Descriptors (SVDs). */
-        TvResolutionParseContext_t ctx = { .resolutions = resolutions };
-        (void)dshalEdidForEachCtaDataBlock(edid_buf, edid_len, parseSupportedResolutionsFromCtaDataBlock, &ctx);
-
-        free(edid_buf);
+        /* Short Video Descriptors (SVDs) from the CTA-861 extension blocks. */
+        for (int i = 0; i < caps.vicCount; i++) {
+            const dsTVResolution_t *tvRes = getResolutionFromVic(caps.vics[i]);
+            if (tvRes != NULL) {
+                *resolutions |= (int)(*tvRes);
+            }
+        }
     } else {
         hal_err("Get supported resolution for TV on Non HDMI Port\n");
         return dsERR_INVALID_PARAM;
@@ -1447,18 +1590,19 @@ dsError_t  dsIsDisplaySurround(intptr_t handle, bool *surround)
     }
 
     *surround = false;
-    unsigned char *edid_buf = NULL;
-    int edid_len = 0;
+    dshalEdidCapabilities_t caps;
 
-    if (getHdmiEdidForConnectedDisplay(dsVIDEOPORT_TYPE_HDMI, 0, &edid_buf, &edid_len) != dsERR_NONE) {
+    if (getHdmiCapabilitiesForConnectedDisplay(&caps) != dsERR_NONE) {
         hal_warn("EDID unavailable; cannot determine surround support\n");
         return dsERR_GENERAL;
     }
 
-    SurroundParseContext_t ctx = { .surround = surround };
-    (void)dshalEdidForEachCtaDataBlock(edid_buf, edid_len, parseSurroundFromCtaDataBlock, &ctx);
-
-    free(edid_buf);
+    for (int i = 0; i < caps.sadCount; i++) {
+        if (caps.sads[i].channels > 2) {
+            *surround = true;
+            break;
+        }
+    }
     hal_info("Display surround support: %s\n", *surround ? "true" : "false");
     return dsERR_NONE;
 }
@@ -0,0 +1,84 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DSVIDEOPORTASYNC_H
+#define __DSVIDEOPORTASYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsVideoPort.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Outcome of an asynchronous resolution change.
+ */
+typedef struct _dsResolutionSwitchResult_t {
+    uint32_t requestId;                 /* Id returned by dsSetResolutionAsync() */
+    dsError_t status;                   /* dsERR_NONE once the mode is confirmed active */
+    bool superseded;                    /* Replaced by a later request before it was applied */
+    char activeMode[32];                /* RDK resolution name active afterwards; empty if unknown */
+    unsigned int switchTimeMs;          /* From start of the switch to confirmation or failure; 0 if not applied */
+} dsResolutionSwitchResult_t;
+
+/**
+ * @brief Completion callback for dsSetResolutionAsync().
+ *
+ * Called once per request, from the video port worker thread, or from the
+ * dsSetResolutionAsync() call that superseded it.
+ */
+typedef void (*dsResolutionSwitchCB_t)(intptr_t handle, const dsResolutionSwitchResult_t *result, void *userData);
+
+/**
+ * @brief Queues a resolution change and returns without waiting for it.
+ *
+ * The change is applied on a video port worker thread exactly as dsSetResolution()
+ * would, including the framerate pre/post-change callbacks. Requests are coalesced:
+ * only the latest pending one is applied, and a request still pending when a newer
+ * one arrives completes with superseded set and status dsERR_OPERATION_FAILED.
+ * Synchronous dsSetResolution() calls are serialised with the worker.
+ *
+ * @param[in]  handle      - Handle of the video port returned from dsGetVideoPort()
+ * @param[in]  resolution  - Video resolution. Please refer ::dsVideoPortResolution_t
+ * @param[in]  cb          - Completion callback; may be NULL
+ * @param[in]  userData    - Opaque pointer passed back to cb
+ * @param[out] requestId   - Id reported in the result; may be NULL
+ *
+ * @return dsError_t                      -  Status
+ * @retval dsERR_NONE                     -  Request queued
+ * @retval dsERR_NOT_INITIALIZED          -  Module is not initialised
+ * @retval dsERR_INVALID_PARAM            -  Parameter passed to this function is invalid
+ * @retval dsERR_OPERATION_NOT_SUPPORTED  -  The port is not HDMI
+ * @retval dsERR_RESOURCE_NOT_AVAILABLE   -  The worker thread could not be started
+ *
+ * @pre dsVideoPortInit() and dsGetVideoPort() must be called before calling this API.
+ *
+ * @see dsSetResolution()
+ */
+dsError_t dsSetResolutionAsync(intptr_t handle, const dsVideoPortResolution_t *resolution,
+        dsResolutionSwitchCB_t cb, void *userData, uint32_t *requestId);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
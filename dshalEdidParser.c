@@ -22,6 +22,7 @@
 #include "dshalEdidParser.h"
 
 #include <stdint.h>
+#include <string.h>
 
 bool dshalEdidForEachCtaDataBlock(const unsigned char *edid,
         int edidLen,
@@ -76,3 +77,134 @@ bool dshalEdidForEachCtaDataBlock(const unsigned char *edid,
 
     return true;
 }
+
+static bool dshalEdidOuiMatches(const unsigned char *data, unsigned char b0, unsigned char b1, unsigned char b2)
+{
+    return data[0] == b0 && data[1] == b1 && data[2] == b2;
+}
+
+static void dshalEdidAddTmds(dshalEdidCapabilities_t *caps, unsigned char fiveMHzUnits)
+{
+    uint32_t kHz = (uint32_t)fiveMHzUnits * 5000u;
+    if (kHz > caps->maxTmdsKHz) {
+        caps->maxTmdsKHz = kHz;
+    }
+}
+
+static bool dshalEdidAnalyzeCtaDataBlock(int tag, const unsigned char *data, int dataLen, void *context)
+{
+    dshalEdidCapabilities_t *caps = (dshalEdidCapabilities_t *)context;
+
+    switch (tag) {
+        case DSHAL_EDID_CTA_DATA_BLOCK_TAG_VIDEO:
+            for (int i = 0; i < dataLen && caps->vicCount < DSHAL_EDID_MAX_VICS; i++) {
+                uint8_t vic = data[i] & 0x7F;
+                bool seen = false;
+                for (int j = 0; j < caps->vicCount && !seen; j++) {
+                    seen = (caps->vics[j] == vic);
+                }
+                if (!seen) {
+                    caps->vics[caps->vicCount++] = vic;
+                }
+            }
+            break;
+
+        case DSHAL_EDID_CTA_DATA_BLOCK_TAG_AUDIO:
+            for (int i = 0; (i + (DSHAL_EDID_CTA_SHORT_AUDIO_DESCRIPTOR_LEN - 1)) < dataLen &&
+                    caps->sadCount < DSHAL_EDID_MAX_SADS; i += DSHAL_EDID_CTA_SHORT_AUDIO_DESCRIPTOR_LEN) {
+                dshalEdidSad_t *sad = &caps->sads[caps->sadCount++];
+                sad->format = (data[i] >> 3) & 0x0F;
+                sad->channels = (data[i] & 0x07) + 1;
+                sad->sampleRates = data[i + 1] & 0x7F;
+                sad->extra = data[i + 2];
+            }
+            break;
+
+        case DSHAL_EDID_CTA_VENDOR_SPECIFIC_TAG:
+            if (dataLen < 3) {
+                break;
+            }
+            if (dshalEdidOuiMatches(data, DSHAL_EDID_HDMI_VSDB_OUI_BYTE0,
+                        DSHAL_EDID_HDMI_VSDB_OUI_BYTE1, DSHAL_EDID_HDMI_VSDB_OUI_BYTE2)) {
+                if (dataLen >= 6) {
+                    caps->deepColor |= data[5] & (DSHAL_EDID_DEEP_COLOR_Y444 | DSHAL_EDID_DEEP_COLOR_30BIT |
+                            DSHAL_EDID_DEEP_COLOR_36BIT | DSHAL_EDID_DEEP_COLOR_48BIT);
+                }
+                if (dataLen >= 7) {
+                    dshalEdidAddTmds(caps, data[6]);
+                }
+            } else if (dshalEdidOuiMatches(data, DSHAL_EDID_HF_VSDB_OUI_BYTE0,
+                        DSHAL_EDID_HF_VSDB_OUI_BYTE1, DSHAL_EDID_HF_VSDB_OUI_BYTE2)) {
+                if (dataLen >= 5) {
+                    dshalEdidAddTmds(caps, data[4]);
+                }
+            } else if (dshalEdidOuiMatches(data, DSHAL_EDID_DOLBY_VSIF_OUI_BYTE0,
+                        DSHAL_EDID_DOLBY_VSIF_OUI_BYTE1, DSHAL_EDID_DOLBY_VSIF_OUI_BYTE2)) {
+                caps->dolbyVision = true;
+            } else if (dshalEdidOuiMatches(data, DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE0,
+                        DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE1, DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE2)) {
+                caps->hdr10Plus = true;
+            }
+            break;
+
+        case DSHAL_EDID_CTA_EXTENDED_TAG:
+            if (dataLen < 2) {
+                break;
+            }
+            if (data[0] == DSHAL_EDID_EXT_TAG_HDR_STATIC_METADATA) {
+                caps->hdrEotfs |= data[1];
+            } else if (data[0] == DSHAL_EDID_EXT_TAG_COLORIMETRY) {
+                caps->colorimetry |= data[1];
+            } else if (data[0] == DSHAL_EDID_EXT_TAG_VENDOR_SPECIFIC_VIDEO && dataLen >= 4) {
+                /* Dolby Vision and HDR10+ are normally advertised here rather than in a VSDB. */
+                if (dshalEdidOuiMatches(data + 1, DSHAL_EDID_DOLBY_VSIF_OUI_BYTE0,
+                            DSHAL_EDID_DOLBY_VSIF_OUI_BYTE1, DSHAL_EDID_DOLBY_VSIF_OUI_BYTE2)) {
+                    caps->dolbyVision = true;
+                } else if (dshalEdidOuiMatches(data + 1, DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE0,
+                            DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE1, DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE2)) {
+                    caps->hdr10Plus = true;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+bool dshalEdidAnalyze(const unsigned char *edid,
+        int edidLen,
+        dshalEdidCapabilities_t *caps)
+{
+    if (caps == 0) {
+        return false;
+    }
+    memset(caps, 0, sizeof(*caps));
+    if (edid == 0 || edidLen < DSHAL_EDID_BLOCK_SIZE) {
+        return false;
+    }
+
+    /* Monitor name: display descriptor 0xFC, up to 13 characters ending in 0x0A. */
+    for (int d = 0; d < DSHAL_EDID_DESCRIPTOR_COUNT; d++) {
+        const unsigned char *desc = edid + DSHAL_EDID_DESCRIPTOR_OFFSET + d * DSHAL_EDID_DESCRIPTOR_LEN;
+        if (desc[0] != 0 || desc[1] != 0 || desc[3] != DSHAL_EDID_DESCRIPTOR_MONITOR_NAME) {
+            continue;
+        }
+        int n = 0;
+        for (int i = 5; i < DSHAL_EDID_DESCRIPTOR_LEN && n < DSHAL_EDID_MONITOR_NAME_LEN - 1; i++) {
+            if (desc[i] == 0x0A) {
+                break;
+            }
+            caps->monitorName[n++] = (char)desc[i];
+        }
+        while (n > 0 && caps->monitorName[n - 1] == ' ') {
+            n--;
+        }
+        caps->monitorName[n] = '\0';
+        break;
+    }
+
+    return dshalEdidForEachCtaDataBlock(edid, edidLen, dshalEdidAnalyzeCtaDataBlock, caps);
+}
@@ -58,6 +58,55 @@
 #define DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE1       0x84
 #define DSHAL_EDID_HDR10PLUS_VSIF_OUI_BYTE2       0x90
 
+#define DSHAL_EDID_EXT_TAG_VENDOR_SPECIFIC_VIDEO  0x01
+#define DSHAL_EDID_EXT_TAG_COLORIMETRY            0x05
+
+#define DSHAL_EDID_HDMI_VSDB_OUI_BYTE0            0x03
+#define DSHAL_EDID_HDMI_VSDB_OUI_BYTE1            0x0C
+#define DSHAL_EDID_HDMI_VSDB_OUI_BYTE2            0x00
+
+#define DSHAL_EDID_HF_VSDB_OUI_BYTE0              0xD8
+#define DSHAL_EDID_HF_VSDB_OUI_BYTE1              0x5D
+#define DSHAL_EDID_HF_VSDB_OUI_BYTE2              0xC4
+
+#define DSHAL_EDID_DESCRIPTOR_OFFSET              54
+#define DSHAL_EDID_DESCRIPTOR_LEN                 18
+#define DSHAL_EDID_DESCRIPTOR_COUNT               4
+#define DSHAL_EDID_DESCRIPTOR_MONITOR_NAME        0xFC
+
+#define DSHAL_EDID_MAX_VICS                       64
+#define DSHAL_EDID_MAX_SADS                       32
+#define DSHAL_EDID_MONITOR_NAME_LEN               14
+
+/* HDMI VSDB deep colour flags (byte 6 of the block) */
+#define DSHAL_EDID_DEEP_COLOR_Y444                0x08
+#define DSHAL_EDID_DEEP_COLOR_30BIT               0x10
+#define DSHAL_EDID_DEEP_COLOR_36BIT               0x20
+#define DSHAL_EDID_DEEP_COLOR_48BIT               0x40
+
+typedef struct {
+    uint8_t format;         /* Audio format code (1 = LPCM, 2 = AC-3, 10 = E-AC-3, ...) */
+    uint8_t channels;
+    uint8_t sampleRates;    /* Sample rate bitmap */
+    uint8_t extra;          /* LPCM bit depths, or format specific */
+} dshalEdidSad_t;
+
+/* Everything the HAL reads from the CTA extensions, filled in one pass by dshalEdidAnalyze(). */
+typedef struct {
+    uint32_t hash;                          /* Hash of the EDID this was built from; set by the caller */
+    int vicCount;
+    uint8_t vics[DSHAL_EDID_MAX_VICS];      /* Short video descriptors, de-duplicated, in EDID order */
+    uint8_t hdrEotfs;                       /* HDR static metadata EOTF bits (SDR, HDR, ST 2084, HLG) */
+    bool dolbyVision;
+    bool hdr10Plus;
+    int sadCount;
+    dshalEdidSad_t sads[DSHAL_EDID_MAX_SADS];
+    uint8_t colorimetry;                    /* Colorimetry data block byte 1 (xvYCC, BT.2020, ...) */
+    uint8_t deepColor;                      /* DSHAL_EDID_DEEP_COLOR_* */
+    uint32_t maxTmdsKHz;                    /* Highest of the HDMI and HF VSDB limits; 0 if not given */
+    char monitorName[DSHAL_EDID_MONITOR_NAME_LEN];
+} dshalEdidCapabilities_t;
+
 typedef bool (*dshalEdidCtaDataBlockVisitor_t)(int tag,
         const unsigned char *data,
         int dataLen,
@@ -68,4 +117,9 @@ bool dshalEdidForEachCtaDataBlock(const unsigned char *edid,
         dshalEdidCtaDataBlockVisitor_t visitor,
         void *context);
 
+/* Fills caps from the base block and all CTA extensions; returns false for a too-short EDID. */
+bool dshalEdidAnalyze(const unsigned char *edid,
+        int edidLen,
+        dshalEdidCapabilities_t *caps);
+
 #endif /* __DSHAL_EDID_PARSER_H__ */
@@ -27,16 +27,21 @@
 #include <limits.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <errno.h>
 #include <stddef.h>
+#include <dirent.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/uio.h>
+#include <poll.h>
+#include <time.h>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 
 #include "dshalUtils.h"
 #include "dshalLogger.h"
+#include "dsVideoResolutionSettings.h"
 
 int dsOpenDrmCardFd(void)
 {
@@ -60,105 +65,416 @@ int dsOpenDrmCardFd(void)
     return fd;
 }
 
-bool dsGetHdmiConnectorState(bool *connected, bool *enabled)
+/*
+ * Shared DRM context: one fd for the HAL plus the cached drmModeRes and the HDMI
+ * connector topology (connector/encoder/CRTC ids and the last state read from
+ * each connector). The fd stays open between the first dsDrmContextAcquire() and
+ * the last dsDrmContextRelease(); queries made outside that window use a
+ * short-lived fd. dsDrmContextInvalidate() drops the cached resources so the next
+ * query re-enumerates the connectors.
+ */
+typedef struct {
+    uint32_t connectorId;
+    uint32_t encoderId;
+    uint32_t crtcId;
+    uint32_t edidPropId;
+    uint32_t edidBlobId;
+    bool connected;
+    bool enabled;
+    char currentMode[DS_HDMI_MODE_NAME_LEN];
+    char preferredMode[DS_HDMI_MODE_NAME_LEN];
+} dsHdmiConnectorEntry_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int refCount;
+    int fd;
+    drmModeRes *resources;
+    dsHdmiConnectorEntry_t hdmi[DS_MAX_HDMI_CONNECTORS];
+    int hdmiCount;
+} dsDrmContext_t;
+
+static dsDrmContext_t gDrmContext = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .refCount = 0,
+    .fd = -1,
+    .resources = NULL,
+    .hdmiCount = 0,
+};
+
+/*
+ * Last published HDMI snapshot, guarded by a seqlock: the sequence is odd while a
+ * write is in progress and 0 until the first publish. Writers are serialised by
+ * gDrmContext.lock. Readers only trust it while it is live, i.e. while the hotplug
+ * watcher keeps it current.
+ */
+static dsHdmiSnapshot_t gHdmiSnapshot;
+static atomic_uint gHdmiSnapshotSeq = ATOMIC_VAR_INIT(0);
+static atomic_bool gHdmiSnapshotLive = ATOMIC_VAR_INIT(false);
+
+static bool dsIsHdmiConnectorType(uint32_t type)
 {
-    int drmFd = -1;
-    drmModeRes *resources = NULL;
-    bool foundConnector = false;
-    bool bestConnected = false;
-    bool bestEnabled = false;
+    return (type == DRM_MODE_CONNECTOR_HDMIA)
+#ifdef DRM_MODE_CONNECTOR_HDMIB
+        || (type == DRM_MODE_CONNECTOR_HDMIB)
+#endif
+        ;
+}
 
-    if (connected == NULL || enabled == NULL) {
-        return false;
+static void dsDrmContextDropResourcesLocked(void)
+{
+    if (gDrmContext.resources != NULL) {
+        drmModeFreeResources(gDrmContext.resources);
+        gDrmContext.resources = NULL;
     }
+    gDrmContext.hdmiCount = 0;
+}
 
-    *connected = false;
-    *enabled = false;
+/* Shared fd when the context is held, otherwise a short-lived one for this query. */
+static int dsDrmContextGetFdLocked(void)
+{
+    return (gDrmContext.fd >= 0) ? gDrmContext.fd : dsOpenDrmCardFd();
+}
 
-    drmFd = dsOpenDrmCardFd();
-    if (drmFd < 0) {
-        hal_err("Failed to open DRM card for connector state\n");
+static void dsDrmContextPutFdLocked(int drmFd)
+{
+    if (drmFd >= 0 && drmFd != gDrmContext.fd) {
+        close(drmFd);
+    }
+}
+
+bool dsDrmContextAcquire(void)
+{
+    bool ok = true;
+
+    pthread_mutex_lock(&gDrmContext.lock);
+    if (gDrmContext.refCount == 0) {
+        gDrmContext.fd = dsOpenDrmCardFd();
+        if (gDrmContext.fd < 0) {
+            hal_err("Failed to open DRM card for the shared context\n");
+            ok = false;
+        }
+    }
+    if (ok) {
+        gDrmContext.refCount++;
+    }
+    pthread_mutex_unlock(&gDrmContext.lock);
+
+    return ok;
+}
+
+void dsDrmContextRelease(void)
+{
+    pthread_mutex_lock(&gDrmContext.lock);
+    if (gDrmContext.refCount > 0 && --gDrmContext.refCount == 0) {
+        dsDrmContextDropResourcesLocked();
+        close(gDrmContext.fd);
+        gDrmContext.fd = -1;
+    }
+    pthread_mutex_unlock(&gDrmContext.lock);
+}
+
+void dsDrmContextInvalidate(void)
+{
+    pthread_mutex_lock(&gDrmContext.lock);
+    dsDrmContextDropResourcesLocked();
+    pthread_mutex_unlock(&gDrmContext.lock);
+}
+
+/* Value of the connector's EDID blob property; the property id is looked up once per connector. */
+static uint32_t dsReadEdidBlobId(int drmFd, drmModeConnector *connector, dsHdmiConnectorEntry_t *entry)
+{
+    for (int i = 0; i < connector->count_props; i++) {
+        if (entry->edidPropId == 0) {
+            drmModePropertyRes *prop = drmModeGetProperty(drmFd, connector->props[i]);
+            if (prop) {
+                if (strcmp(prop->name, "EDID") == 0) {
+                    entry->edidPropId = prop->prop_id;
+                }
+                drmModeFreeProperty(prop);
+            }
+        }
+        if (entry->edidPropId != 0 && connector->props[i] == entry->edidPropId) {
+            return (uint32_t)connector->prop_values[i];
+        }
+    }
+    return 0;
+}
+
+/* Reads connection and CRTC state; the encoder is only looked up again when the binding changed. */
+static void dsReadHdmiConnectorEntry(int drmFd, drmModeConnector *connector, dsHdmiConnectorEntry_t *entry)
+{
+    entry->connectorId = connector->connector_id;
+    entry->connected = (connector->connection == DRM_MODE_CONNECTED);
+    entry->enabled = false;
+    entry->currentMode[0] = '\0';
+    entry->preferredMode[0] = '\0';
+    entry->edidBlobId = dsReadEdidBlobId(drmFd, connector, entry);
+
+    if (connector->count_modes > 0) {
+        int preferredIndex = 0;
+        for (int m = 0; m < connector->count_modes; m++) {
+            if (connector->modes[m].type & DRM_MODE_TYPE_PREFERRED) {
+                preferredIndex = m;
+                break;
+            }
+        }
+        snprintf(entry->preferredMode, sizeof(entry->preferredMode), "%s", connector->modes[preferredIndex].name);
+    }
+
+    if (connector->encoder_id == 0) {
+        entry->encoderId = 0;
+        entry->crtcId = 0;
+    } else if (connector->encoder_id != entry->encoderId || entry->crtcId == 0) {
+        drmModeEncoder *encoder = drmModeGetEncoder(drmFd, connector->encoder_id);
+        entry->encoderId = connector->encoder_id;
+        entry->crtcId = 0;
+        if (encoder) {
+            entry->crtcId = encoder->crtc_id;
+            drmModeFreeEncoder(encoder);
+        }
+    }
+
+    if (entry->crtcId != 0) {
+        drmModeCrtc *crtc = drmModeGetCrtc(drmFd, entry->crtcId);
+        if (crtc) {
+            entry->enabled = crtc->mode_valid;
+            if (crtc->mode_valid) {
+                snprintf(entry->currentMode, sizeof(entry->currentMode), "%s", crtc->mode.name);
+            }
+            drmModeFreeCrtc(crtc);
+        }
+    }
+
+    if (!entry->enabled && entry->connected && connector->count_modes > 0 && connector->encoder_id != 0) {
+        entry->enabled = true;
+    }
+}
+
+static bool dsDrmContextReadEntryLocked(int drmFd, dsHdmiConnectorEntry_t *entry)
+{
+    drmModeConnector *connector = drmModeGetConnectorCurrent(drmFd, entry->connectorId);
+
+    if (!connector) {
         return false;
     }
+    dsReadHdmiConnectorEntry(drmFd, connector, entry);
+    drmModeFreeConnector(connector);
+    return true;
+}
 
-    resources = drmModeGetResources(drmFd);
-    if (!resources) {
-        close(drmFd);
+/*
+ * Enumerates the HDMI connectors and reads their state, once per invalidation.
+ * Sets *loaded when this call did the enumeration, i.e. the entries are fresh.
+ */
+static bool dsDrmContextLoadLocked(int drmFd, bool *loaded)
+{
+    *loaded = false;
+    if (gDrmContext.resources != NULL) {
+        return (gDrmContext.hdmiCount > 0);
+    }
+
+    gDrmContext.resources = drmModeGetResources(drmFd);
+    if (!gDrmContext.resources) {
         return false;
     }
 
-    for (int i = 0; i < resources->count_connectors; i++) {
-        bool entryConnected = false;
-        bool entryEnabled = false;
-        drmModeConnector *connector = drmModeGetConnectorCurrent(drmFd, resources->connectors[i]);
+    gDrmContext.hdmiCount = 0;
+    for (int i = 0; i < gDrmContext.resources->count_connectors && gDrmContext.hdmiCount < DS_MAX_HDMI_CONNECTORS; i++) {
+        drmModeConnector *connector = drmModeGetConnectorCurrent(drmFd, gDrmContext.resources->connectors[i]);
 
         if (!connector) {
-            connector = drmModeGetConnector(drmFd, resources->connectors[i]);
+            connector = drmModeGetConnector(drmFd, gDrmContext.resources->connectors[i]);
         }
         if (!connector) {
             continue;
         }
 
-        if (connector->connector_type != DRM_MODE_CONNECTOR_HDMIA
-#ifdef DRM_MODE_CONNECTOR_HDMIB
-            && connector->connector_type != DRM_MODE_CONNECTOR_HDMIB
-#endif
-        ) {
-            drmModeFreeConnector(connector);
-            continue;
+        if (dsIsHdmiConnectorType(connector->connector_type)) {
+            dsHdmiConnectorEntry_t *entry = &gDrmContext.hdmi[gDrmContext.hdmiCount++];
+            memset(entry, 0, sizeof(*entry));
+            dsReadHdmiConnectorEntry(drmFd, connector, entry);
         }
+        drmModeFreeConnector(connector);
+    }
 
-        entryConnected = (connector->connection == DRM_MODE_CONNECTED);
+    *loaded = true;
+    return (gDrmContext.hdmiCount > 0);
+}
 
-        if (connector->encoder_id != 0) {
-            drmModeEncoder *encoder = drmModeGetEncoder(drmFd, connector->encoder_id);
-            if (encoder) {
-                drmModeCrtc *crtc = drmModeGetCrtc(drmFd, encoder->crtc_id);
-                if (crtc) {
-                    entryEnabled = crtc->mode_valid;
-                    drmModeFreeCrtc(crtc);
-                }
-                drmModeFreeEncoder(encoder);
-            }
-        }
+static void dsHdmiSnapshotPublishLocked(const dsHdmiConnectorEntry_t *entry)
+{
+    unsigned int seq = atomic_load_explicit(&gHdmiSnapshotSeq, memory_order_relaxed);
 
-        if (!entryEnabled && entryConnected && connector->count_modes > 0 && connector->encoder_id != 0) {
-            entryEnabled = true;
-        }
+    atomic_store_explicit(&gHdmiSnapshotSeq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
 
-        if (entryConnected && entryEnabled) {
-            bestConnected = true;
-            bestEnabled = true;
-            foundConnector = true;
-            drmModeFreeConnector(connector);
+    gHdmiSnapshot.sequence = (seq + 2) / 2;
+    gHdmiSnapshot.connected = entry->connected;
+    gHdmiSnapshot.enabled = entry->enabled;
+    gHdmiSnapshot.connectorId = entry->connectorId;
+    gHdmiSnapshot.edidBlobId = entry->edidBlobId;
+    memcpy(gHdmiSnapshot.currentMode, entry->currentMode, sizeof(gHdmiSnapshot.currentMode));
+    memcpy(gHdmiSnapshot.preferredMode, entry->preferredMode, sizeof(gHdmiSnapshot.preferredMode));
+
+    atomic_store_explicit(&gHdmiSnapshotSeq, seq + 2, memory_order_release);
+}
+
+/*
+ * Reports the first connected and enabled connector, else the first one found,
+ * and publishes it as the current snapshot.
+ */
+static void dsDrmContextAggregateLocked(bool *connected, bool *enabled)
+{
+    const dsHdmiConnectorEntry_t *selected = &gDrmContext.hdmi[0];
+
+    for (int i = 0; i < gDrmContext.hdmiCount; i++) {
+        if (gDrmContext.hdmi[i].connected && gDrmContext.hdmi[i].enabled) {
+            selected = &gDrmContext.hdmi[i];
             break;
         }
+    }
 
-        if (!foundConnector) {
-            bestConnected = entryConnected;
-            bestEnabled = entryEnabled;
+    *connected = selected->connected;
+    *enabled = selected->enabled;
+    dsHdmiSnapshotPublishLocked(selected);
+}
+
+void dsHdmiSnapshotSetLive(bool live)
+{
+    atomic_store_explicit(&gHdmiSnapshotLive, live, memory_order_release);
+}
+
+/* Seqlock read of the last published snapshot, live or not. */
+static bool dsHdmiSnapshotRead(dsHdmiSnapshot_t *snapshot)
+{
+    for (;;) {
+        unsigned int before = atomic_load_explicit(&gHdmiSnapshotSeq, memory_order_acquire);
+        if (before == 0) {
+            return false;
         }
+        if (before & 1u) {
+            continue;
+        }
+        *snapshot = gHdmiSnapshot;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&gHdmiSnapshotSeq, memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+}
 
-        foundConnector = true;
-        drmModeFreeConnector(connector);
+bool dsGetHdmiSnapshot(dsHdmiSnapshot_t *snapshot)
+{
+    if (snapshot == NULL || !atomic_load_explicit(&gHdmiSnapshotLive, memory_order_acquire)) {
+        return false;
     }
+    return dsHdmiSnapshotRead(snapshot);
+}
 
-    drmModeFreeResources(resources);
-    close(drmFd);
+bool dsGetHdmiConnectorStateCached(bool *connected, bool *enabled)
+{
+    dsHdmiSnapshot_t snapshot;
 
-    if (!foundConnector) {
+    if (connected == NULL || enabled == NULL) {
         return false;
     }
+    if (dsGetHdmiSnapshot(&snapshot)) {
+        *connected = snapshot.connected;
+        *enabled = snapshot.enabled;
+        return true;
+    }
+    return dsGetHdmiConnectorState(connected, enabled);
+}
 
-    *connected = bestConnected;
-    *enabled = bestEnabled;
-    return true;
+bool dsGetHdmiConnectorState(bool *connected, bool *enabled)
+{
+    int drmFd = -1;
+    bool loaded = false;
+    bool ok = false;
+
+    if (connected == NULL || enabled == NULL) {
+        return false;
+    }
+
+    *connected = false;
+    *enabled = false;
+
+    pthread_mutex_lock(&gDrmContext.lock);
+    drmFd = dsDrmContextGetFdLocked();
+    if (drmFd < 0) {
+        pthread_mutex_unlock(&gDrmContext.lock);
+        hal_err("Failed to open DRM card for connector state\n");
+        return false;
+    }
+
+    ok = dsDrmContextLoadLocked(drmFd, &loaded);
+    for (int i = 0; ok && !loaded && i < gDrmContext.hdmiCount; i++) {
+        if (!dsDrmContextReadEntryLocked(drmFd, &gDrmContext.hdmi[i])) {
+            /* Topology changed under us; enumerate again. */
+            dsDrmContextDropResourcesLocked();
+            ok = dsDrmContextLoadLocked(drmFd, &loaded);
+        }
+    }
+    if (ok) {
+        dsDrmContextAggregateLocked(connected, enabled);
+    }
+
+    dsDrmContextPutFdLocked(drmFd);
+    pthread_mutex_unlock(&gDrmContext.lock);
+
+    return ok;
+}
+
+bool dsRefreshHdmiConnectorState(uint32_t connectorId, bool *connected, bool *enabled)
+{
+    int drmFd = -1;
+    bool loaded = false;
+    bool ok = false;
+
+    if (connected == NULL || enabled == NULL) {
+        return false;
+    }
+
+    pthread_mutex_lock(&gDrmContext.lock);
+    drmFd = dsDrmContextGetFdLocked();
+    if (drmFd < 0) {
+        pthread_mutex_unlock(&gDrmContext.lock);
+        hal_err("Failed to open DRM card for connector %u\n", connectorId);
+        return false;
+    }
+
+    ok = dsDrmContextLoadLocked(drmFd, &loaded);
+    if (ok) {
+        int index = -1;
+        for (int i = 0; i < gDrmContext.hdmiCount; i++) {
+            if (gDrmContext.hdmi[i].connectorId == connectorId) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) {
+            ok = false;
+        } else if (!loaded && !dsDrmContextReadEntryLocked(drmFd, &gDrmContext.hdmi[index])) {
+            hal_warn("Connector %u vanished; enumerating connectors again\n", connectorId);
+            dsDrmContextDropResourcesLocked();
+            ok = dsDrmContextLoadLocked(drmFd, &loaded);
+        }
+    }
+    if (ok) {
+        dsDrmContextAggregateLocked(connected, enabled);
+    }
+
+    dsDrmContextPutFdLocked(drmFd);
+    pthread_mutex_unlock(&gDrmContext.lock);
+
+    return ok;
 }
 
 bool dsGetPreferredHdmiMode(char *mode, size_t len)
 {
     int drmFd = -1;
-    drmModeRes *resources = NULL;
+    bool loaded = false;
     drmModeModeInfo selectedMode = {0};
     bool haveMode = false;
     bool selectedConnected = false;
@@ -169,35 +485,28 @@ bool dsGetPreferredHdmiMode(char *mode, size_t len)
 
     mode[0] = '\0';
 
-    drmFd = dsOpenDrmCardFd();
+    pthread_mutex_lock(&gDrmContext.lock);
+    drmFd = dsDrmContextGetFdLocked();
     if (drmFd < 0) {
+        pthread_mutex_unlock(&gDrmContext.lock);
         return false;
     }
 
-    resources = drmModeGetResources(drmFd);
-    if (!resources) {
-        close(drmFd);
+    if (!dsDrmContextLoadLocked(drmFd, &loaded)) {
+        dsDrmContextPutFdLocked(drmFd);
+        pthread_mutex_unlock(&gDrmContext.lock);
         return false;
     }
 
-    for (int i = 0; i < resources->count_connectors; i++) {
-        drmModeConnector *connector = drmModeGetConnectorCurrent(drmFd, resources->connectors[i]);
+    for (int i = 0; i < gDrmContext.hdmiCount; i++) {
+        drmModeConnector *connector = drmModeGetConnectorCurrent(drmFd, gDrmContext.hdmi[i].connectorId);
         if (!connector) {
-            connector = drmModeGetConnector(drmFd, resources->connectors[i]);
+            connector = drmModeGetConnector(drmFd, gDrmContext.hdmi[i].connectorId);
         }
         if (!connector) {
             continue;
         }
 
-        if (connector->connector_type != DRM_MODE_CONNECTOR_HDMIA
-#ifdef DRM_MODE_CONNECTOR_HDMIB
-            && connector->connector_type != DRM_MODE_CONNECTOR_HDMIB
-#endif
-        ) {
-            drmModeFreeConnector(connector);
-            continue;
-        }
-
         if (connector->count_modes <= 0) {
             drmModeFreeConnector(connector);
             continue;
@@ -213,35 +522,634 @@ bool dsGetPreferredHdmiMode(char *mode, size_t len)
 
         bool entryConnected = (connector->connection == DRM_MODE_CONNECTED);
 
-        if (entryConnected) {
-            selectedMode = connector->modes[preferredIndex];
-            haveMode = true;
-            selectedConnected = true;
-            drmModeFreeConnector(connector);
-            break;
-        }
+        if (entryConnected) {
+            selectedMode = connector->modes[preferredIndex];
+            haveMode = true;
+            selectedConnected = true;
+            drmModeFreeConnector(connector);
+            break;
+        }
+
+        if (!haveMode) {
+            selectedMode = connector->modes[preferredIndex];
+            haveMode = true;
+        }
+
+        drmModeFreeConnector(connector);
+    }
+
+    dsDrmContextPutFdLocked(drmFd);
+    pthread_mutex_unlock(&gDrmContext.lock);
+
+    if (!haveMode) {
+        return false;
+    }
+
+    snprintf(mode, len, "%s", selectedMode.name);
+    if (!selectedConnected) {
+        hal_dbg("No connected HDMI mode found; returning first available mode '%s'\n", mode);
+    }
+
+    return (mode[0] != '\0');
+}
+
+/*
+ * Mode-switch completion. The CRTC driving the connected HDMI connector is read
+ * directly; between reads the waiter sleeps on a vblank event queued on the shared
+ * DRM fd, so it re-checks once per frame. While the CRTC is off mid-modeset no vblank
+ * can be queued and the wait falls back to short timeouts. Only the caller's own vblank
+ * events are queued on the fd, so no other reader is disturbed.
+ */
+#define DS_MODESET_IDLE_RECHECK_MS 20
+#define DS_MODESET_VBLANK_RECHECK_MS 100 /* Upper bound if a queued vblank never fires */
+
+/* Refresh rate in Hz, from the clock when the driver left vrefresh unset. */
+static int dsModeRefreshHz(const drmModeModeInfo *mode)
+{
+    if (mode->vrefresh != 0) {
+        return (int)mode->vrefresh;
+    }
+    if (mode->htotal == 0 || mode->vtotal == 0) {
+        return 0;
+    }
+    unsigned long long refresh = ((unsigned long long)mode->clock * 1000ULL + (mode->htotal * mode->vtotal) / 2) /
+            ((unsigned long long)mode->htotal * mode->vtotal);
+    if (mode->flags & DRM_MODE_FLAG_INTERLACE) {
+        refresh *= 2;
+    }
+    return (int)refresh;
+}
+
+/* Reads the active mode of the first connected HDMI connector's CRTC. */
+static bool dsReadHdmiActiveModeLocked(int drmFd, drmModeModeInfo *mode, uint32_t *crtcId)
+{
+    bool loaded = false;
+
+    if (!dsDrmContextLoadLocked(drmFd, &loaded)) {
+        return false;
+    }
+    for (int i = 0; i < gDrmContext.hdmiCount; i++) {
+        dsHdmiConnectorEntry_t *entry = &gDrmContext.hdmi[i];
+        if (!loaded && !dsDrmContextReadEntryLocked(drmFd, entry)) {
+            continue;
+        }
+        if (!entry->connected || entry->crtcId == 0) {
+            continue;
+        }
+        drmModeCrtc *crtc = drmModeGetCrtc(drmFd, entry->crtcId);
+        if (crtc == NULL) {
+            continue;
+        }
+        bool valid = crtc->mode_valid;
+        if (valid) {
+            *mode = crtc->mode;
+            *crtcId = entry->crtcId;
+        }
+        drmModeFreeCrtc(crtc);
+        return valid;
+    }
+    return false;
+}
+
+static bool dsRequestVblankEventLocked(int drmFd, uint32_t crtcId)
+{
+    int pipe = -1;
+    drmVBlank vbl;
+
+    for (int i = 0; gDrmContext.resources != NULL && i < gDrmContext.resources->count_crtcs; i++) {
+        if (gDrmContext.resources->crtcs[i] == crtcId) {
+            pipe = i;
+            break;
+        }
+    }
+    if (pipe < 0) {
+        return false;
+    }
+
+    memset(&vbl, 0, sizeof(vbl));
+    vbl.request.type = (drmVBlankSeqType)(DRM_VBLANK_RELATIVE | DRM_VBLANK_EVENT);
+    if (pipe == 1) {
+        vbl.request.type = (drmVBlankSeqType)(vbl.request.type | DRM_VBLANK_SECONDARY);
+    } else if (pipe > 1) {
+        vbl.request.type = (drmVBlankSeqType)(vbl.request.type |
+                ((pipe << DRM_VBLANK_HIGH_CRTC_SHIFT) & DRM_VBLANK_HIGH_CRTC_MASK));
+    }
+    vbl.request.sequence = 1;
+    return (drmWaitVBlank(drmFd, &vbl) == 0);
+}
+
+static long long dsMonotonicMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+bool dsWaitHdmiCrtcMode(int width, int height, bool interlaced, int refreshHz, int timeoutMs, int *elapsedMs)
+{
+    drmEventContext eventContext;
+    long long start = dsMonotonicMs();
+    long long deadline = start + timeoutMs;
+    bool matched = false;
+    bool pending = false;
+
+    if (!dsDrmContextAcquire()) {
+        return false;
+    }
+    memset(&eventContext, 0, sizeof(eventContext));
+    eventContext.version = DRM_EVENT_CONTEXT_VERSION;
+
+    for (;;) {
+        drmModeModeInfo mode;
+        uint32_t crtcId = 0;
+        int drmFd;
+        bool vblankQueued = pending;
+
+        pthread_mutex_lock(&gDrmContext.lock);
+        drmFd = gDrmContext.fd;
+        if (dsReadHdmiActiveModeLocked(drmFd, &mode, &crtcId)) {
+            matched = (mode.hdisplay == width && mode.vdisplay == height &&
+                    ((mode.flags & DRM_MODE_FLAG_INTERLACE) != 0) == interlaced &&
+                    dsModeRefreshHz(&mode) == refreshHz);
+            if (matched) {
+                bool connected = false, enabled = false;
+                /* A modeset raises no hotplug, so republish the snapshot with the new CRTC mode. */
+                dsDrmContextAggregateLocked(&connected, &enabled);
+            } else if (!vblankQueued) {
+                vblankQueued = dsRequestVblankEventLocked(drmFd, crtcId);
+            }
+        }
+        pthread_mutex_unlock(&gDrmContext.lock);
+
+        long long remaining = deadline - dsMonotonicMs();
+        if (matched || remaining <= 0) {
+            break;
+        }
+
+        /* A queued vblank wakes us at the next frame; without one, re-check shortly. */
+        struct pollfd pfd = { .fd = drmFd, .events = POLLIN, .revents = 0 };
+        long long waitMs = vblankQueued ? DS_MODESET_VBLANK_RECHECK_MS : DS_MODESET_IDLE_RECHECK_MS;
+        if (waitMs > remaining) {
+            waitMs = remaining;
+        }
+        int pollRet = poll(&pfd, 1, (int)waitMs);
+        pending = vblankQueued;
+        if (pollRet > 0 && (pfd.revents & POLLIN)) {
+            (void)drmHandleEvent(drmFd, &eventContext);
+            pending = false;
+        } else if (pollRet < 0 && errno != EINTR) {
+            hal_err("poll on DRM fd failed: %s\n", strerror(errno));
+            break;
+        }
+    }
+
+    dsDrmContextRelease();
+    if (elapsedMs != NULL) {
+        *elapsedMs = (int)(dsMonotonicMs() - start);
+    }
+    return matched;
+}
+
+/*
+ * DRM atomic modeset backend. The target mode is taken from the connected HDMI
+ * connector's own mode list, so a mode the display does not advertise is rejected
+ * without touching the CRTC. The commit itself needs DRM master, which westeros
+ * normally holds; without it the kernel refuses the request and the caller falls
+ * back to westeros. Planes are left to the compositor.
+ */
+typedef struct {
+    uint32_t connectorId;
+    uint32_t crtcId;
+    drmModeModeInfo mode;
+} dsAtomicModeTarget_t;
+
+static uint32_t dsDrmFindPropertyId(int drmFd, uint32_t objectId, uint32_t objectType, const char *name)
+{
+    drmModeObjectProperties *props = drmModeObjectGetProperties(drmFd, objectId, objectType);
+    uint32_t propId = 0;
+
+    if (props == NULL) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < props->count_props && propId == 0; i++) {
+        drmModePropertyRes *prop = drmModeGetProperty(drmFd, props->props[i]);
+        if (prop) {
+            if (strcmp(prop->name, name) == 0) {
+                propId = prop->prop_id;
+            }
+            drmModeFreeProperty(prop);
+        }
+    }
+    drmModeFreeObjectProperties(props);
+    return propId;
+}
+
+/* CRTC driving the connector now, else the first CRTC one of its encoders can use. */
+static uint32_t dsDrmPickCrtc(int drmFd, const drmModeRes *resources, const drmModeConnector *connector)
+{
+    uint32_t crtcId = 0;
+
+    if (connector->encoder_id != 0) {
+        drmModeEncoder *encoder = drmModeGetEncoder(drmFd, connector->encoder_id);
+        if (encoder) {
+            crtcId = encoder->crtc_id;
+            drmModeFreeEncoder(encoder);
+        }
+    }
+    for (int e = 0; crtcId == 0 && e < connector->count_encoders; e++) {
+        drmModeEncoder *encoder = drmModeGetEncoder(drmFd, connector->encoders[e]);
+        if (encoder == NULL) {
+            continue;
+        }
+        for (int c = 0; c < resources->count_crtcs; c++) {
+            if (encoder->possible_crtcs & (1u << c)) {
+                crtcId = resources->crtcs[c];
+                break;
+            }
+        }
+        drmModeFreeEncoder(encoder);
+    }
+    return crtcId;
+}
+
+/*
+ * Finds the first connected HDMI connector and the advertised mode matching the request,
+ * preferring the display's preferred mode when several have the same timing class.
+ */
+static dsError_t dsDrmBuildModeTarget(int drmFd, int width, int height, bool interlaced, int refreshHz,
+        dsAtomicModeTarget_t *target)
+{
+    drmModeRes *resources = drmModeGetResources(drmFd);
+    dsError_t ret = dsERR_OPERATION_NOT_SUPPORTED;
+
+    if (resources == NULL) {
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    for (int i = 0; i < resources->count_connectors; i++) {
+        drmModeConnector *connector = drmModeGetConnectorCurrent(drmFd, resources->connectors[i]);
+        if (connector == NULL) {
+            continue;
+        }
+        if (!dsIsHdmiConnectorType(connector->connector_type) || connector->connection != DRM_MODE_CONNECTED ||
+                connector->count_modes == 0) {
+            drmModeFreeConnector(connector);
+            continue;
+        }
+
+        int match = -1;
+        for (int m = 0; m < connector->count_modes; m++) {
+            const drmModeModeInfo *mode = &connector->modes[m];
+            if (mode->hdisplay != width || mode->vdisplay != height ||
+                    ((mode->flags & DRM_MODE_FLAG_INTERLACE) != 0) != interlaced ||
+                    dsModeRefreshHz(mode) != refreshHz) {
+                continue;
+            }
+            if (match < 0 || (mode->type & DRM_MODE_TYPE_PREFERRED)) {
+                match = m;
+            }
+        }
+        if (match < 0) {
+            hal_err("Mode %dx%d%c%d is not in the mode list of connector %u\n", width, height,
+                    interlaced ? 'i' : 'p', refreshHz, connector->connector_id);
+            ret = dsERR_INVALID_PARAM;
+        } else {
+            target->connectorId = connector->connector_id;
+            target->crtcId = dsDrmPickCrtc(drmFd, resources, connector);
+            target->mode = connector->modes[match];
+            ret = (target->crtcId != 0) ? dsERR_NONE : dsERR_OPERATION_NOT_SUPPORTED;
+        }
+        drmModeFreeConnector(connector);
+        break;
+    }
+    drmModeFreeResources(resources);
+    return ret;
+}
+
+dsError_t dsDrmAtomicSetHdmiMode(int width, int height, bool interlaced, int refreshHz, bool testOnly)
+{
+    dsAtomicModeTarget_t target;
+    dsError_t ret;
+    int drmFd = dsOpenDrmCardFd();
+
+    if (drmFd < 0) {
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    memset(&target, 0, sizeof(target));
+    ret = dsDrmBuildModeTarget(drmFd, width, height, interlaced, refreshHz, &target);
+    if (ret != dsERR_NONE) {
+        close(drmFd);
+        return ret;
+    }
+
+    if (drmSetClientCap(drmFd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0 ||
+            drmSetClientCap(drmFd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+        hal_warn("DRM atomic modesetting is not available\n");
+        close(drmFd);
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+
+    uint32_t connCrtcProp = dsDrmFindPropertyId(drmFd, target.connectorId, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID");
+    uint32_t modeIdProp = dsDrmFindPropertyId(drmFd, target.crtcId, DRM_MODE_OBJECT_CRTC, "MODE_ID");
+    uint32_t activeProp = dsDrmFindPropertyId(drmFd, target.crtcId, DRM_MODE_OBJECT_CRTC, "ACTIVE");
+    if (connCrtcProp == 0 || modeIdProp == 0 || activeProp == 0) {
+        hal_warn("DRM atomic properties missing on connector %u / CRTC %u\n", target.connectorId, target.crtcId);
+        close(drmFd);
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+
+    uint32_t modeBlobId = 0;
+    if (drmModeCreatePropertyBlob(drmFd, &target.mode, sizeof(target.mode), &modeBlobId) != 0) {
+        hal_err("Failed to create a mode blob for '%s'\n", target.mode.name);
+        close(drmFd);
+        return dsERR_GENERAL;
+    }
+
+    drmModeAtomicReq *req = drmModeAtomicAlloc();
+    if (req == NULL) {
+        drmModeDestroyPropertyBlob(drmFd, modeBlobId);
+        close(drmFd);
+        return dsERR_GENERAL;
+    }
+    uint32_t flags = DRM_MODE_ATOMIC_ALLOW_MODESET | (testOnly ? DRM_MODE_ATOMIC_TEST_ONLY : 0);
+    int commitRet = -ENOMEM;
+    if (drmModeAtomicAddProperty(req, target.connectorId, connCrtcProp, target.crtcId) >= 0 &&
+            drmModeAtomicAddProperty(req, target.crtcId, modeIdProp, modeBlobId) >= 0 &&
+            drmModeAtomicAddProperty(req, target.crtcId, activeProp, 1) >= 0) {
+        commitRet = drmModeAtomicCommit(drmFd, req, flags, NULL);
+    }
+    /* drmModeAtomicCommit() returns -errno; capture it before the cleanup calls below. */
+    int commitErr = (commitRet < 0) ? -commitRet : 0;
+    drmModeAtomicFree(req);
+    drmModeDestroyPropertyBlob(drmFd, modeBlobId);
+    close(drmFd);
+
+    if (commitRet == 0) {
+        hal_dbg("Atomic %s of '%s' on CRTC %u succeeded\n", testOnly ? "test" : "commit", target.mode.name, target.crtcId);
+        return dsERR_NONE;
+    }
+    if (commitErr == EACCES || commitErr == EPERM) {
+        hal_warn("Atomic modeset refused; the HAL is not DRM master\n");
+        return dsERR_OPERATION_NOT_SUPPORTED;
+    }
+    hal_err("Atomic %s of '%s' failed: %s\n", testOnly ? "test" : "commit", target.mode.name, strerror(commitErr));
+    return (commitErr == EINVAL || commitErr == ERANGE) ? dsERR_INVALID_PARAM : dsERR_GENERAL;
+}
+
+/*
+ * EDID of the connected display. dsEdidCacheRefresh() reads it (DRM EDID blob
+ * first, sysfs as fallback) and is called once per hotplug; readers copy it out
+ * of memory. The FNV-1a hash identifies the content so callers can tell when
+ * the display behind the port changed.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    bool valid;
+    uint32_t hash;
+    int length;
+    unsigned char bytes[MAX_EDID_BYTES_LEN];
+    bool capsValid;                     /* caps were analysed from the EDID with caps.hash */
+    dshalEdidCapabilities_t caps;
+} dsEdidCache_t;
+
+static dsEdidCache_t gEdidCache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .valid = false,
+    .hash = 0,
+    .length = 0,
+    .capsValid = false,
+};
+
+static uint32_t dsEdidHash(const unsigned char *bytes, int length)
+{
+    uint32_t hash = 2166136261u;
+
+    for (int i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool dsReadEdidBlob(uint32_t blobId, unsigned char *edid, int *length)
+{
+    int drmFd = -1;
+    drmModePropertyBlobRes *blob = NULL;
+
+    pthread_mutex_lock(&gDrmContext.lock);
+    drmFd = dsDrmContextGetFdLocked();
+    if (drmFd >= 0) {
+        blob = drmModeGetPropertyBlob(drmFd, blobId);
+        if (blob) {
+            *length = (blob->length > MAX_EDID_BYTES_LEN) ? MAX_EDID_BYTES_LEN : (int)blob->length;
+            memcpy(edid, blob->data, *length);
+            drmModeFreePropertyBlob(blob);
+        }
+        dsDrmContextPutFdLocked(drmFd);
+    }
+    pthread_mutex_unlock(&gDrmContext.lock);
+
+    return (blob != NULL && *length > 0);
+}
+
+/* Reads the EDID of the connected HDMI0 connector from /sys/class/drm/<card>-HDMI-A-1/edid. */
+static bool dsReadEdidSysfs(unsigned char *edid, int *length)
+{
+    char edid_path[PATH_MAX] = {0};
+    char status_path[PATH_MAX] = {0};
+    const char *cardPath = getenv("WESTEROS_DRM_CARD");
+    const char *cardName = NULL;
+    DIR *drm_class = NULL;
+    struct dirent *entry;
+
+    if (cardPath == NULL || cardPath[0] == '\0') {
+        cardPath = DRI_CARD;
+    }
+    cardName = strrchr(cardPath, '/');
+    cardName = (cardName != NULL) ? (cardName + 1) : cardPath;
+
+    drm_class = opendir("/sys/class/drm");
+    if (!drm_class) {
+        hal_err("Failed to open /sys/class/drm\n");
+        return false;
+    }
+
+    *length = 0;
+    while ((entry = readdir(drm_class)) != NULL) {
+        if (strncmp(entry->d_name, cardName, strlen(cardName)) != 0) {
+            continue; /* Skip entries not matching our card */
+        }
+        if (strstr(entry->d_name, "HDMI-A-1") == NULL) {
+            continue; /* Focus on HDMI0 connector only */
+        }
+
+        int status_len = snprintf(status_path, sizeof(status_path), "/sys/class/drm/%s/status", entry->d_name);
+        if (status_len < 0 || (size_t)status_len >= sizeof(status_path)) {
+            hal_warn("Status path truncated for connector '%s'\n", entry->d_name);
+            continue;
+        }
+
+        FILE *status_file = fopen(status_path, "r");
+        if (status_file == NULL) {
+            hal_warn("Failed to open connector status at %s\n", status_path);
+            continue;
+        }
+
+        char status[16] = {0};
+        if (fgets(status, sizeof(status), status_file) == NULL) {
+            fclose(status_file);
+            hal_warn("Failed to read connector status from %s\n", status_path);
+            continue;
+        }
+        fclose(status_file);
+
+        if (strncmp(status, "connected", strlen("connected")) != 0) {
+            hal_dbg("Skipping disconnected connector %s (status=%s)\n", entry->d_name, status);
+            continue;
+        }
+
+        int path_len = snprintf(edid_path, sizeof(edid_path), "/sys/class/drm/%s/edid", entry->d_name);
+        if (path_len < 0 || (size_t)path_len >= sizeof(edid_path)) {
+            hal_warn("EDID path truncated for connector '%s'\n", entry->d_name);
+            continue;
+        }
+        FILE *edid_file = fopen(edid_path, "rb");
+        if (!edid_file) {
+            hal_dbg("EDID file not found at %s\n", edid_path);
+            continue;
+        }
+
+        *length = (int)fread(edid, 1, MAX_EDID_BYTES_LEN, edid_file);
+        fclose(edid_file);
+
+        if (*length <= 0) {
+            hal_err("Failed to read EDID from %s\n", edid_path);
+            *length = 0;
+        } else {
+            hal_dbg("Read %d bytes of EDID from %s\n", *length, edid_path);
+        }
+        break;
+    }
+    closedir(drm_class);
+
+    return (*length > 0);
+}
+
+bool dsEdidCacheRefresh(bool *changed)
+{
+    dsHdmiSnapshot_t snapshot;
+    bool connected = false;
+    bool enabled = false;
+    bool ok = false;
+
+    if (changed != NULL) {
+        *changed = false;
+    }
+
+    /* Use the live snapshot when the watcher keeps one; otherwise read (and publish) it now. */
+    if (!dsGetHdmiSnapshot(&snapshot)) {
+        if (!dsGetHdmiConnectorState(&connected, &enabled) || !dsHdmiSnapshotRead(&snapshot)) {
+            return false;
+        }
+    }
+
+    pthread_mutex_lock(&gEdidCache.lock);
+    /* The hash outlives a disconnect, so replugging the same display is not a change. */
+    uint32_t previousHash = gEdidCache.hash;
+
+    gEdidCache.valid = false;
+    gEdidCache.length = 0;
+    if (snapshot.connected) {
+        if (snapshot.edidBlobId != 0) {
+            ok = dsReadEdidBlob(snapshot.edidBlobId, gEdidCache.bytes, &gEdidCache.length);
+        }
+        if (!ok) {
+            ok = dsReadEdidSysfs(gEdidCache.bytes, &gEdidCache.length);
+        }
+    }
+    if (ok) {
+        gEdidCache.hash = dsEdidHash(gEdidCache.bytes, gEdidCache.length);
+        gEdidCache.valid = true;
+        hal_dbg("EDID cached: %d bytes, hash 0x%08x (blob %u)\n", gEdidCache.length, gEdidCache.hash, snapshot.edidBlobId);
+    }
+    if (changed != NULL) {
+        *changed = ok && (gEdidCache.hash != previousHash);
+    }
+    pthread_mutex_unlock(&gEdidCache.lock);
+
+    return ok;
+}
+
+void dsEdidCacheInvalidate(void)
+{
+    pthread_mutex_lock(&gEdidCache.lock);
+    gEdidCache.valid = false;
+    gEdidCache.length = 0;
+    pthread_mutex_unlock(&gEdidCache.lock);
+}
+
+/* Without a live watcher nothing refreshes the cache on hotplug, so read the display now. */
+static void dsEdidCacheEnsure(void)
+{
+    bool valid;
+
+    pthread_mutex_lock(&gEdidCache.lock);
+    valid = gEdidCache.valid;
+    pthread_mutex_unlock(&gEdidCache.lock);
+
+    if (!valid || !atomic_load_explicit(&gHdmiSnapshotLive, memory_order_acquire)) {
+        (void)dsEdidCacheRefresh(NULL);
+    }
+}
+
+bool dsEdidCacheGet(unsigned char *edid, int *length, uint32_t *hash)
+{
+    bool ok = false;
+
+    if (edid == NULL || length == NULL) {
+        return false;
+    }
 
-        if (!haveMode) {
-            selectedMode = connector->modes[preferredIndex];
-            haveMode = true;
+    dsEdidCacheEnsure();
+    pthread_mutex_lock(&gEdidCache.lock);
+    if (gEdidCache.valid) {
+        memcpy(edid, gEdidCache.bytes, gEdidCache.length);
+        *length = gEdidCache.length;
+        if (hash != NULL) {
+            *hash = gEdidCache.hash;
         }
-
-        drmModeFreeConnector(connector);
+        ok = true;
     }
+    pthread_mutex_unlock(&gEdidCache.lock);
 
-    drmModeFreeResources(resources);
-    close(drmFd);
+    return ok;
+}
 
-    if (!haveMode) {
+bool dsEdidCacheGetCapabilities(dshalEdidCapabilities_t *caps)
+{
+    bool ok = false;
+
+    if (caps == NULL) {
         return false;
     }
 
-    snprintf(mode, len, "%s", selectedMode.name);
-    if (!selectedConnected) {
-        hal_dbg("No connected HDMI mode found; returning first available mode '%s'\n", mode);
+    dsEdidCacheEnsure();
+    pthread_mutex_lock(&gEdidCache.lock);
+    if (gEdidCache.valid) {
+        if (!gEdidCache.capsValid || gEdidCache.caps.hash != gEdidCache.hash) {
+            (void)dshalEdidAnalyze(gEdidCache.bytes, gEdidCache.length, &gEdidCache.caps);
+            gEdidCache.caps.hash = gEdidCache.hash;
+            gEdidCache.capsValid = true;
+            hal_dbg("EDID 0x%08x analysed: %d VICs, %d SADs, HDR EOTFs 0x%02x, DV %d, HDR10+ %d, max TMDS %u kHz, name '%s'\n",
+                    gEdidCache.hash, gEdidCache.caps.vicCount, gEdidCache.caps.sadCount, gEdidCache.caps.hdrEotfs,
+                    gEdidCache.caps.dolbyVision, gEdidCache.caps.hdr10Plus, gEdidCache.caps.maxTmdsKHz,
+                    gEdidCache.caps.monitorName);
+        }
+        *caps = gEdidCache.caps;
+        ok = true;
     }
+    pthread_mutex_unlock(&gEdidCache.lock);
 
-    return (mode[0] != '\0');
+    return ok;
 }
 
 const hdmiSupportedRes_t resolutionMap[] = {
@@ -274,6 +1182,160 @@ const hdmiSupportedRes_t resolutionMap[] = {
 
 const size_t noOfItemsInResolutionMap = sizeof(resolutionMap) / sizeof(hdmiSupportedRes_t);
 
+/*
+ * Resolution index: kResolutionsSettings and resolutionMap merged into one array sorted
+ * by canonical key and searched with bsearch(). Built once, on first use or from the
+ * display/video port init; both tables are static for the life of the library.
+ */
+#define DS_RESOLUTION_INDEX_MAX 64
+
+typedef struct {
+    dsResolutionKey_t key;
+    const dsVideoPortResolution_t *settings;    /* NULL when kResolutionsSettings has no such mode */
+    const char *mapName;                        /* NULL when resolutionMap has no such mode */
+} dsResolutionIndexEntry_t;
+
+typedef struct {
+    pthread_once_t once;
+    dsResolutionIndexEntry_t entries[DS_RESOLUTION_INDEX_MAX];
+    size_t count;
+} dsResolutionIndex_t;
+
+static dsResolutionIndex_t gResolutionIndex = {
+    .once = PTHREAD_ONCE_INIT,
+    .count = 0,
+};
+
+bool dsResolutionKeyFromName(const char *name, dsResolutionKey_t *key)
+{
+    int width = 0, height = 0, rate = 60, consumed = 0;
+    const char *p = name;
+
+    if (name == NULL || key == NULL) {
+        return false;
+    }
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (!isdigit((unsigned char)*p)) {
+        return false;
+    }
+    if (sscanf(p, "%dx%d%n", &width, &height, &consumed) == 2 ||
+            sscanf(p, "%d%n", &height, &consumed) == 1) {
+        p += consumed;
+    }
+    char scan = (char)tolower((unsigned char)*p);
+    if (scan != 'p' && scan != 'i') {
+        return false;
+    }
+    p++;
+    if (isdigit((unsigned char)*p)) {
+        if (sscanf(p, "%d%n", &rate, &consumed) != 1) {
+            return false;
+        }
+        p += consumed;
+    }
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (*p != '\0' || height <= 0 || height > 0xFFFF || rate <= 0 || rate > 0x7FFF) {
+        return false;
+    }
+    *key = DS_RESOLUTION_KEY(height, scan == 'i', rate);
+    return true;
+}
+
+static int dsResolutionIndexCompare(const void *a, const void *b)
+{
+    dsResolutionKey_t x = ((const dsResolutionIndexEntry_t *)a)->key;
+    dsResolutionKey_t y = ((const dsResolutionIndexEntry_t *)b)->key;
+    return (x > y) - (x < y);
+}
+
+/* Entry for key, added if missing. Only used while the index is being built. */
+static dsResolutionIndexEntry_t *dsResolutionIndexSlot(dsResolutionKey_t key)
+{
+    for (size_t i = 0; i < gResolutionIndex.count; i++) {
+        if (gResolutionIndex.entries[i].key == key) {
+            return &gResolutionIndex.entries[i];
+        }
+    }
+    if (gResolutionIndex.count >= DS_RESOLUTION_INDEX_MAX) {
+        return NULL;
+    }
+    dsResolutionIndexEntry_t *entry = &gResolutionIndex.entries[gResolutionIndex.count++];
+    entry->key = key;
+    entry->settings = NULL;
+    entry->mapName = NULL;
+    return entry;
+}
+
+/* The first table entry for a key wins, as the linear scans did. */
+static void dsResolutionIndexBuild(void)
+{
+    for (size_t i = 0; i < kNumResolutionsSettings; i++) {
+        dsResolutionKey_t key;
+        dsResolutionIndexEntry_t *entry;
+        if (!dsResolutionKeyFromName(kResolutionsSettings[i].name, &key)) {
+            hal_warn("Resolution '%s' has no canonical key, not indexed\n", kResolutionsSettings[i].name);
+            continue;
+        }
+        entry = dsResolutionIndexSlot(key);
+        if (entry == NULL) {
+            hal_err("Resolution index full, '%s' not indexed\n", kResolutionsSettings[i].name);
+        } else if (entry->settings == NULL) {
+            entry->settings = &kResolutionsSettings[i];
+        }
+    }
+    for (size_t i = 0; i < noOfItemsInResolutionMap; i++) {
+        dsResolutionKey_t key;
+        dsResolutionIndexEntry_t *entry;
+        if (!dsResolutionKeyFromName(resolutionMap[i].rdkRes, &key)) {
+            continue;
+        }
+        entry = dsResolutionIndexSlot(key);
+        if (entry == NULL) {
+            hal_err("Resolution index full, '%s' not indexed\n", resolutionMap[i].rdkRes);
+        } else if (entry->mapName == NULL) {
+            entry->mapName = resolutionMap[i].rdkRes;
+        }
+    }
+    qsort(gResolutionIndex.entries, gResolutionIndex.count, sizeof(gResolutionIndex.entries[0]), dsResolutionIndexCompare);
+    hal_dbg("Resolution index built with %zu keys\n", gResolutionIndex.count);
+}
+
+void dsResolutionIndexInit(void)
+{
+    (void)pthread_once(&gResolutionIndex.once, dsResolutionIndexBuild);
+}
+
+static const dsResolutionIndexEntry_t *dsResolutionIndexFind(dsResolutionKey_t key)
+{
+    dsResolutionIndexEntry_t probe = { .key = key };
+
+    dsResolutionIndexInit();
+    return bsearch(&probe, gResolutionIndex.entries, gResolutionIndex.count,
+            sizeof(gResolutionIndex.entries[0]), dsResolutionIndexCompare);
+}
+
+const dsVideoPortResolution_t *dsResolutionSettingsByKey(dsResolutionKey_t key)
+{
+    const dsResolutionIndexEntry_t *entry = dsResolutionIndexFind(key);
+    return entry ? entry->settings : NULL;
+}
+
+const char *dsResolutionMapNameByKey(dsResolutionKey_t key)
+{
+    const dsResolutionIndexEntry_t *entry = dsResolutionIndexFind(key);
+    return entry ? entry->mapName : NULL;
+}
+
+const dsVideoPortResolution_t *dsResolutionSettingsByName(const char *name)
+{
+    dsResolutionKey_t key;
+    return dsResolutionKeyFromName(name, &key) ? dsResolutionSettingsByKey(key) : NULL;
+}
+
 const VicMapEntry vicMapTable[] = {
     // 480i resolutions
     {6, dsTV_RESOLUTION_480i},    // 720x480i @ 59.94/60Hz
@@ -600,39 +1662,41 @@ const char *getXDGRuntimeDir()
     return NULL;
 }
 
-/**
- * @brief Send a display command to the westeros display socket and receive the response.
- * @param cmd The display command to send (for example: 'set display enable 1').
- *                 set display enable 1/0
- *                 get mode
- *                 set mode 1920x1080p25
- * @param resp Buffer to receive the response from the display socket.
- * @param respSize Size of the response buffer.
- * @return true if the command was sent and a response was received successfully, false otherwise.
+/*
+ * Persistent client connection to the westeros display socket. Commands are framed
+ * as 'D' 'S' <len> <payload incl. NUL>, and the server answers each one with a frame
+ * in the same order, so several commands can share one write and the replies are
+ * matched by position. Bytes past the last expected reply are dropped with the
+ * connection, never carried into the next call.
  */
-bool westerosGLConsoleRWWrapper(const char *cmd, char *resp, size_t respSize)
-{
-    if (cmd == NULL || resp == NULL || respSize == 0) {
-        return false;
-    }
-
-    resp[0] = '\0';
-
-    const char *displayCmd = cmd;
-    while (*displayCmd == ' ' || *displayCmd == '\t') {
-        ++displayCmd;
-    }
-
-    if (strstr(displayCmd, "westeros-gl-console") != NULL || strchr(displayCmd, ';') != NULL) {
-        hal_err("westerosGLConsoleRWWrapper expects bare display command (for example: 'set display enable 1')\n");
-        return false;
-    }
+#define WESTEROS_FRAME_HEADER_LEN 3
+#define WESTEROS_MAX_PAYLOAD_LEN 254 /* One-byte length field; reserve payload to <= 254 bytes. */
+#define WESTEROS_REPLY_TIMEOUT_MS 2000
+
+typedef struct {
+    pthread_mutex_t lock;
+    int fd;                                 /* -1 when not connected */
+    unsigned char rx[PATH_MAX];             /* Received bytes not yet parsed into replies */
+    size_t rxLen;
+} dsWesterosConn_t;
+
+static dsWesterosConn_t gWesterosConn = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .fd = -1,
+    .rxLen = 0,
+};
 
-    if (*displayCmd == '\0') {
-        hal_err("Missing westeros display command in '%s'\n", cmd);
-        return false;
+static void westerosCloseLocked(dsWesterosConn_t *conn)
+{
+    if (conn->fd >= 0) {
+        close(conn->fd);
+        conn->fd = -1;
     }
+    conn->rxLen = 0;
+}
 
+static bool westerosConnectLocked(dsWesterosConn_t *conn)
+{
     const char *xdgRuntimeDir = (getXDGRuntimeDir() != NULL) ? getXDGRuntimeDir() : getenv("XDG_RUNTIME_DIR");
     if (xdgRuntimeDir == NULL || xdgRuntimeDir[0] == '\0') {
         hal_err("XDG_RUNTIME_DIR is not set for westeros command\n");
@@ -662,30 +1726,38 @@ bool westerosGLConsoleRWWrapper(const char *cmd, char *resp, size_t respSize)
         return false;
     }
 
-    unsigned char tx[PATH_MAX];
-    size_t displayCmdLen = strlen(displayCmd);
-    size_t payloadLen = displayCmdLen + 1; /* Include terminating NUL per protocol framing. */
-    const size_t maxProtocolPayloadLen = 254; /* One-byte length field; reserve payload to <= 254 bytes. */
+    conn->fd = socketFd;
+    conn->rxLen = 0;
+    hal_dbg("Connected to display socket '%s'\n", addr.sun_path);
+    return true;
+}
 
-    if (payloadLen > maxProtocolPayloadLen) {
-        hal_err("Westeros command is too long for protocol framing (%zu > %zu payload bytes)\n",
-                payloadLen, maxProtocolPayloadLen);
-        close(socketFd);
-        return false;
-    }
-    if (payloadLen > sizeof(tx) - 3) {
-        hal_err("Westeros command payload does not fit tx buffer (%zu bytes)\n", payloadLen);
-        close(socketFd);
-        return false;
+/* Trims and checks one bare display command, returning its start or NULL. */
+static const char *westerosCheckCommand(const char *cmd)
+{
+    const char *displayCmd = cmd;
+    while (*displayCmd == ' ' || *displayCmd == '\t') {
+        ++displayCmd;
     }
 
-    size_t txLen = 0;
-    tx[txLen++] = 'D';
-    tx[txLen++] = 'S';
-    tx[txLen++] = (unsigned char)payloadLen;
-    memcpy(&tx[txLen], displayCmd, payloadLen);
-    txLen += payloadLen;
+    if (strstr(displayCmd, "westeros-gl-console") != NULL || strchr(displayCmd, ';') != NULL) {
+        hal_err("westerosGLConsoleRWWrapper expects bare display command (for example: 'set display enable 1')\n");
+        return NULL;
+    }
+    if (*displayCmd == '\0') {
+        hal_err("Missing westeros display command in '%s'\n", cmd);
+        return NULL;
+    }
+    if (strlen(displayCmd) + 1 > WESTEROS_MAX_PAYLOAD_LEN) {
+        hal_err("Westeros command is too long for protocol framing (%zu > %d payload bytes)\n",
+                strlen(displayCmd) + 1, WESTEROS_MAX_PAYLOAD_LEN);
+        return NULL;
+    }
+    return displayCmd;
+}
 
+static bool westerosSendLocked(dsWesterosConn_t *conn, const unsigned char *tx, size_t txLen)
+{
     size_t sentTotal = 0;
     while (sentTotal < txLen) {
         struct iovec txIov;
@@ -699,85 +1771,191 @@ bool westerosGLConsoleRWWrapper(const char *cmd, char *resp, size_t respSize)
 
         ssize_t sentLen;
         do {
-            sentLen = sendmsg(socketFd, &txMsg, MSG_NOSIGNAL);
+            sentLen = sendmsg(conn->fd, &txMsg, MSG_NOSIGNAL);
         } while (sentLen < 0 && errno == EINTR);
 
         if (sentLen <= 0) {
-            hal_err("Failed to send display command '%s'\n", displayCmd);
-            close(socketFd);
             return false;
         }
-
         sentTotal += (size_t)sentLen;
     }
+    return true;
+}
+
+/*
+ * Receives the next reply frame and copies its payload (up to the NUL) into resp.
+ * Returns 1 on success, 0 when the server closed the connection before any byte of
+ * this reply arrived, and -1 on timeout, read error or bad framing.
+ */
+static int westerosRecvReplyLocked(dsWesterosConn_t *conn, char *resp, size_t respSize)
+{
+    for (;;) {
+        if (conn->rxLen >= WESTEROS_FRAME_HEADER_LEN) {
+            if (conn->rx[0] != 'D' || conn->rx[1] != 'S') {
+                return -1;
+            }
+            size_t msgLen = conn->rx[2];
+            size_t frameLen = msgLen + WESTEROS_FRAME_HEADER_LEN;
+            if (msgLen == 0) {
+                return -1;
+            }
+            if (conn->rxLen >= frameLen) {
+                const char *payload = (const char *)&conn->rx[WESTEROS_FRAME_HEADER_LEN];
+                const char *nulTerminator = memchr(payload, '\0', msgLen);
+                size_t copyLen = nulTerminator ? (size_t)(nulTerminator - payload) : msgLen;
+                if (copyLen >= respSize) {
+                    copyLen = respSize - 1;
+                }
+                memcpy(resp, payload, copyLen);
+                resp[copyLen] = '\0';
+
+                conn->rxLen -= frameLen;
+                memmove(conn->rx, &conn->rx[frameLen], conn->rxLen);
+                return 1;
+            }
+        }
+
+        struct pollfd pfd = { .fd = conn->fd, .events = POLLIN, .revents = 0 };
+        int pollRet;
+        do {
+            pollRet = poll(&pfd, 1, WESTEROS_REPLY_TIMEOUT_MS);
+        } while (pollRet < 0 && errno == EINTR);
+        if (pollRet <= 0) {
+            hal_err("Timed out waiting for display response\n");
+            return -1;
+        }
 
-    unsigned char rx[PATH_MAX] = {0};
-    size_t recvTotal = 0;
-    while (recvTotal < sizeof(rx)) {
         ssize_t recvLen;
         do {
-            recvLen = recv(socketFd, &rx[recvTotal], sizeof(rx) - recvTotal, 0);
+            recvLen = recv(conn->fd, &conn->rx[conn->rxLen], sizeof(conn->rx) - conn->rxLen, 0);
         } while (recvLen < 0 && errno == EINTR);
 
+        if (recvLen == 0) {
+            return (conn->rxLen == 0) ? 0 : -1;
+        }
         if (recvLen < 0) {
-            close(socketFd);
-            hal_err("Failed to receive display response for '%s'\n", displayCmd);
+            return -1;
+        }
+        conn->rxLen += (size_t)recvLen;
+    }
+}
+
+bool westerosGLConsoleRWBatch(dsWesterosCommand_t *cmds, size_t count)
+{
+    dsWesterosConn_t *conn = &gWesterosConn;
+    unsigned char tx[PATH_MAX];
+    size_t txLen = 0;
+
+    if (cmds == NULL || count == 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (cmds[i].cmd == NULL || cmds[i].resp == NULL || cmds[i].respSize == 0) {
             return false;
         }
-        if (recvLen == 0) {
-            break;
+        cmds[i].resp[0] = '\0';
+
+        const char *displayCmd = westerosCheckCommand(cmds[i].cmd);
+        if (displayCmd == NULL) {
+            return false;
         }
 
-        recvTotal += (size_t)recvLen;
+        size_t payloadLen = strlen(displayCmd) + 1; /* Include terminating NUL per protocol framing. */
+        if (payloadLen > sizeof(tx) - txLen - WESTEROS_FRAME_HEADER_LEN) {
+            hal_err("Westeros command batch does not fit tx buffer (%zu commands)\n", count);
+            return false;
+        }
+        tx[txLen++] = 'D';
+        tx[txLen++] = 'S';
+        tx[txLen++] = (unsigned char)payloadLen;
+        memcpy(&tx[txLen], displayCmd, payloadLen);
+        txLen += payloadLen;
+    }
 
-        if (recvTotal >= 3) {
-            if (rx[0] != 'D' || rx[1] != 'S') {
+    pthread_mutex_lock(&conn->lock);
+
+    /*
+     * A reused connection may have been closed by the server since the last call.
+     * That shows up as a failed send or as EOF before the first reply, in which case
+     * nothing was processed and the batch is resent once on a fresh connection.
+     */
+    bool reused = (conn->fd >= 0);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (conn->fd < 0) {
+            reused = false;
+            if (!westerosConnectLocked(conn)) {
                 break;
             }
+        }
+        conn->rxLen = 0;
 
-            size_t frameLen = (size_t)rx[2] + 3;
-            if (frameLen > sizeof(rx)) {
-                break;
+        if (!westerosSendLocked(conn, tx, txLen)) {
+            hal_warn("Failed to send display command '%s' (errno %d)\n", cmds[0].cmd, errno);
+            westerosCloseLocked(conn);
+            if (reused) {
+                continue;
             }
-            if (recvTotal >= frameLen) {
+            break;
+        }
+
+        size_t replies = 0;
+        int status = 1;
+        while (replies < count) {
+            status = westerosRecvReplyLocked(conn, cmds[replies].resp, cmds[replies].respSize);
+            if (status <= 0) {
                 break;
             }
+            replies++;
         }
-    }
-
-    close(socketFd);
 
-    if (recvTotal == 0) {
-        hal_err("Failed to receive display response for '%s'\n", displayCmd);
-        return false;
-    }
-
-    unsigned char *m = rx;
-    size_t remaining = recvTotal;
-    while (remaining >= 4) {
-        if (m[0] != 'D' || m[1] != 'S') {
-            break;
+        if (replies == count) {
+            if (conn->rxLen != 0) {
+                hal_warn("Dropping %zu unexpected bytes from display socket\n", conn->rxLen);
+                westerosCloseLocked(conn);
+            }
+            pthread_mutex_unlock(&conn->lock);
+            return true;
         }
 
-        int msgLen = m[2];
-        if (remaining < (size_t)(msgLen + 3)) {
-            break;
+        westerosCloseLocked(conn);
+        if (status == 0 && replies == 0 && reused) {
+            hal_dbg("Display socket closed by server, reconnecting\n");
+            continue;
         }
+        hal_err("Failed to receive display response for '%s'\n", cmds[replies].cmd);
+        break;
+    }
 
-        const char *payload = (const char *)&m[3];
-        const char *nulTerminator = memchr(payload, '\0', (size_t)msgLen);
-        size_t copyLen = nulTerminator ? (size_t)(nulTerminator - payload) : (size_t)msgLen;
-        if (copyLen >= respSize) {
-            copyLen = respSize - 1;
-        }
-        memcpy(resp, payload, copyLen);
-        resp[copyLen] = '\0';
+    pthread_mutex_unlock(&conn->lock);
+    return false;
+}
 
-        return true;
+/**
+ * @brief Send a display command to the westeros display socket and receive the response.
+ * @param cmd The display command to send (for example: 'set display enable 1').
+ *                 set display enable 1/0
+ *                 get mode
+ *                 set mode 1920x1080p25
+ * @param resp Buffer to receive the response from the display socket.
+ * @param respSize Size of the response buffer.
+ * @return true if the command was sent and a response was received successfully, false otherwise.
+ */
+bool westerosGLConsoleRWWrapper(const char *cmd, char *resp, size_t respSize)
+{
+    dsWesterosCommand_t command = { .cmd = cmd, .resp = resp, .respSize = respSize };
+
+    if (cmd == NULL || resp == NULL || respSize == 0) {
+        return false;
     }
+    return westerosGLConsoleRWBatch(&command, 1);
+}
 
-    hal_err("Invalid display response framing for '%s'\n", displayCmd);
-    return false;
+void westerosGLConsoleClose(void)
+{
+    pthread_mutex_lock(&gWesterosConn.lock);
+    westerosCloseLocked(&gWesterosConn);
+    pthread_mutex_unlock(&gWesterosConn.lock);
 }
 
 const dsTVResolution_t *getResolutionFromVic(int vic)
@@ -799,3 +1977,117 @@ const int *getVicFromResolution(dsTVResolution_t resolution)
     }
     return NULL;  // VIC not found
 }
+
+/*
+ * Display event subscriber registry. Slots are fixed so that publishing never
+ * allocates; the list is copied under the lock and the callbacks run outside it.
+ * Unsubscribe shifts the later slots down, so the used slots stay packed at the
+ * front in subscription order and a new subscriber always goes after them.
+ * activeFanouts lets an unsubscribe from another thread wait for in-flight
+ * callbacks, while tInFanout lets a callback unsubscribe itself without deadlock.
+ */
+typedef struct {
+    uint32_t token;                 /* 0 marks a free slot */
+    dsDisplayEventSubscriber_t subscriber;
+    void *userData;
+} dsDisplayEventSlot_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t idle;
+    dsDisplayEventSlot_t slots[dsDISPLAY_EVENT_MAX_SUBSCRIBERS];
+    uint32_t nextToken;
+    unsigned int activeFanouts;
+} dsDisplayEventRegistry_t;
+
+static dsDisplayEventRegistry_t gDisplayEventRegistry = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER,
+    .nextToken = 1,
+};
+static __thread bool tInFanout = false;
+
+dsError_t dsDisplayEventSubscribe(dsDisplayEventSubscriber_t subscriber, void *userData, uint32_t *token)
+{
+    dsDisplayEventRegistry_t *reg = &gDisplayEventRegistry;
+    dsError_t ret = dsERR_RESOURCE_NOT_AVAILABLE;
+
+    if (subscriber == NULL || token == NULL) {
+        hal_err("Invalid params, subscriber %p, token %p\n", subscriber, token);
+        return dsERR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&reg->lock);
+    for (size_t i = 0; i < dsDISPLAY_EVENT_MAX_SUBSCRIBERS; i++) {
+        if (reg->slots[i].token == 0) {
+            reg->slots[i].token = reg->nextToken++;
+            if (reg->nextToken == 0) {
+                reg->nextToken = 1;
+            }
+            reg->slots[i].subscriber = subscriber;
+            reg->slots[i].userData = userData;
+            *token = reg->slots[i].token;
+            ret = dsERR_NONE;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&reg->lock);
+
+    if (ret != dsERR_NONE) {
+        hal_err("No free display event subscriber slot (max %d)\n", dsDISPLAY_EVENT_MAX_SUBSCRIBERS);
+    }
+    return ret;
+}
+
+dsError_t dsDisplayEventUnsubscribe(uint32_t token)
+{
+    dsDisplayEventRegistry_t *reg = &gDisplayEventRegistry;
+    dsError_t ret = dsERR_INVALID_PARAM;
+
+    if (token == 0) {
+        return dsERR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&reg->lock);
+    for (size_t i = 0; i < dsDISPLAY_EVENT_MAX_SUBSCRIBERS; i++) {
+        if (reg->slots[i].token == token) {
+            memmove(&reg->slots[i], &reg->slots[i + 1],
+                    (dsDISPLAY_EVENT_MAX_SUBSCRIBERS - i - 1) * sizeof(reg->slots[0]));
+            memset(&reg->slots[dsDISPLAY_EVENT_MAX_SUBSCRIBERS - 1], 0, sizeof(reg->slots[0]));
+            ret = dsERR_NONE;
+            break;
+        }
+    }
+    while (ret == dsERR_NONE && !tInFanout && reg->activeFanouts > 0) {
+        pthread_cond_wait(&reg->idle, &reg->lock);
+    }
+    pthread_mutex_unlock(&reg->lock);
+    return ret;
+}
+
+void dsDisplayEventPublish(const dsDisplayEventInfo_t *info)
+{
+    dsDisplayEventRegistry_t *reg = &gDisplayEventRegistry;
+    dsDisplayEventSlot_t slots[dsDISPLAY_EVENT_MAX_SUBSCRIBERS];
+
+    if (info == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&reg->lock);
+    memcpy(slots, reg->slots, sizeof(slots));
+    reg->activeFanouts++;
+    pthread_mutex_unlock(&reg->lock);
+
+    tInFanout = true;
+    for (size_t i = 0; i < dsDISPLAY_EVENT_MAX_SUBSCRIBERS && slots[i].token != 0; i++) {
+        slots[i].subscriber(info, slots[i].userData);
+    }
+    tInFanout = false;
+
+    pthread_mutex_lock(&reg->lock);
+    if (--reg->activeFanouts == 0) {
+        pthread_cond_broadcast(&reg->idle);
+    }
+    pthread_mutex_unlock(&reg->lock);
+}
@@ -20,13 +20,33 @@
 #ifndef __DSHALUTILS_H
 #define __DSHALUTILS_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "dsTypes.h"
 #include "dsAVDTypes.h"
+#include "dshalEdidParser.h"
+#include "dsDisplayEventSubscriber.h"
 
 #define WESTEROS_ENV_FILE "/etc/default/westeros-env"
 
+/* RPi4 exposes HDMI-A-1 and HDMI-A-2 */
+#define DS_MAX_HDMI_CONNECTORS 4
+/* Same as DRM_DISPLAY_MODE_LEN */
+#define DS_HDMI_MODE_NAME_LEN 32
+
+/* Immutable copy of the HDMI connector state last read from DRM. */
+typedef struct {
+    uint32_t sequence;          /* Increments on every publish */
+    bool connected;
+    bool enabled;
+    uint32_t connectorId;
+    uint32_t edidBlobId;        /* 0 when the connector has no EDID */
+    char currentMode[DS_HDMI_MODE_NAME_LEN];    /* Empty when the CRTC has no mode */
+    char preferredMode[DS_HDMI_MODE_NAME_LEN];
+} dsHdmiSnapshot_t;
+
 typedef struct {
     int vic;
     dsTVResolution_t tvresolution;
@@ -59,15 +79,101 @@ typedef struct __hdmiSupportedRes_t {
 extern const hdmiSupportedRes_t resolutionMap[];
 extern const size_t noOfItemsInResolutionMap;
 
+/*
+ * Canonical resolution key: height, scan and refresh rate packed into one integer, so
+ * "1920x1080p60", "1080p60" and "1080p" give the same key. A name without a rate means
+ * 60 Hz. dsResolutionKeyFromName() returns false for names it cannot parse.
+ */
+typedef uint32_t dsResolutionKey_t;
+#define DS_RESOLUTION_KEY(height, interlaced, rate) \
+    (((dsResolutionKey_t)(height) << 16) | ((interlaced) ? 0x8000u : 0u) | ((dsResolutionKey_t)(rate) & 0x7FFFu))
+bool dsResolutionKeyFromName(const char *name, dsResolutionKey_t *key);
+/*
+ * Sorted index of kResolutionsSettings and resolutionMap by canonical key, built once.
+ * The lookups build it on first use; init paths call dsResolutionIndexInit() to do it
+ * up front. Lookups are exact: they return NULL when no entry has the key, and a
+ * prefix such as "1080p" never matches "1080p24".
+ */
+void dsResolutionIndexInit(void);
+const dsVideoPortResolution_t *dsResolutionSettingsByKey(dsResolutionKey_t key);
+const dsVideoPortResolution_t *dsResolutionSettingsByName(const char *name);
+/* resolutionMap name (RDK resolution token) for the key, e.g. "720p" for 1280x720p60. */
+const char *dsResolutionMapNameByKey(dsResolutionKey_t key);
+
 int fill_edid_struct(unsigned char *edid, dsDisplayEDID_t *display, int size);
 void parse_edid(const uint8_t *edid, EDID_t *parsed_edid);
 void print_edid(const EDID_t *parsed_edid);
 bool westerosGLConsoleRWWrapper(const char *cmd, char *resp, size_t respSize);
+/*
+ * Westeros display socket commands share one persistent connection that reconnects
+ * on demand. A batch sends all its commands in one write and fills each resp with
+ * the matching reply, in order; it fails if any reply is missing.
+ */
+typedef struct {
+    const char *cmd;                /* Bare display command, e.g. "get mode" */
+    char *resp;
+    size_t respSize;
+} dsWesterosCommand_t;
+bool westerosGLConsoleRWBatch(dsWesterosCommand_t *cmds, size_t count);
+/* Drops the persistent connection; the next command reconnects. */
+void westerosGLConsoleClose(void);
 const dsTVResolution_t *getResolutionFromVic(int vic);
 const int *getVicFromResolution(dsTVResolution_t resolution);
 const char *getXDGRuntimeDir();
 int dsOpenDrmCardFd(void);
+/*
+ * Reference-counted DRM context shared by the display and video port modules. It
+ * keeps one card fd open and caches drmModeRes and the HDMI connector/encoder/CRTC
+ * ids for the connector queries below. Invalidate after a hotplug so the next query
+ * enumerates the connectors again.
+ */
+bool dsDrmContextAcquire(void);
+void dsDrmContextRelease(void);
+void dsDrmContextInvalidate(void);
 bool dsGetHdmiConnectorState(bool *connected, bool *enabled);
+/*
+ * Re-reads one connector (e.g. the CONNECTOR id from a udev hotplug event) and returns
+ * the combined HDMI state. Returns false if the id is not a known HDMI connector.
+ */
+bool dsRefreshHdmiConnectorState(uint32_t connectorId, bool *connected, bool *enabled);
+/*
+ * Every connector read above publishes a snapshot. Once the hotplug watcher marks it
+ * live, dsGetHdmiSnapshot() returns it without touching DRM; it returns false before
+ * the first publish or while no watcher is running. dsGetHdmiConnectorStateCached()
+ * falls back to dsGetHdmiConnectorState() in that case.
+ */
+void dsHdmiSnapshotSetLive(bool live);
+bool dsGetHdmiSnapshot(dsHdmiSnapshot_t *snapshot);
+bool dsGetHdmiConnectorStateCached(bool *connected, bool *enabled);
+/*
+ * EDID cache. dsEdidCacheRefresh() reads the connected display's EDID from the DRM
+ * EDID blob (sysfs as fallback) and sets *changed when its hash differs from the
+ * previous one; the hotplug watcher runs it once per hotplug. dsEdidCacheGet() copies
+ * the cached bytes (at most MAX_EDID_BYTES_LEN) and returns false when no EDID can be
+ * read; without a live watcher it reads the display first.
+ */
+bool dsEdidCacheRefresh(bool *changed);
+void dsEdidCacheInvalidate(void);
+bool dsEdidCacheGet(unsigned char *edid, int *length, uint32_t *hash);
+/* Capabilities of the cached EDID, analysed once per EDID hash. False when no EDID is cached. */
+bool dsEdidCacheGetCapabilities(dshalEdidCapabilities_t *caps);
 bool dsGetPreferredHdmiMode(char *mode, size_t len);
+/*
+ * Waits, up to timeoutMs from the call, until the connected HDMI connector's CRTC runs
+ * the given mode, re-checking on each vblank. On a match it republishes the snapshot.
+ * *elapsedMs (optional) receives the time waited. Returns false on timeout or when DRM
+ * is unavailable.
+ */
+bool dsWaitHdmiCrtcMode(int width, int height, bool interlaced, int refreshHz, int timeoutMs, int *elapsedMs);
+/*
+ * Sets the connected HDMI connector to the advertised mode matching the request with a
+ * DRM atomic commit; testOnly validates it with DRM_MODE_ATOMIC_TEST_ONLY and changes
+ * nothing. Returns dsERR_INVALID_PARAM when the display does not offer the mode or the
+ * kernel rejects it, and dsERR_OPERATION_NOT_SUPPORTED when atomic modesetting is not
+ * usable here (no connected display, no atomic support, or the HAL is not DRM master).
+ */
+dsError_t dsDrmAtomicSetHdmiMode(int width, int height, bool interlaced, int refreshHz, bool testOnly);
+/* Fans one display event out to every dsDisplayEventSubscribe() subscriber, in order. */
+void dsDisplayEventPublish(const dsDisplayEventInfo_t *info);
 
 #endif